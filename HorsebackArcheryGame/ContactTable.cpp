@@ -0,0 +1,149 @@
+#include <algorithm>
+#include "ContactTable.h"
+
+//Events are ordered by pair, the same order a nested loop over every pair would visit them in.
+static bool isEarlierPair(const ContactEvent &event1, const ContactEvent &event2)
+{
+	return event1.horse1 < event2.horse1 || (event1.horse1 == event2.horse1 && event1.horse2 < event2.horse2);
+}
+
+ContactTable::ContactTable()
+{
+	frame = 0;
+}
+
+//Make room for the per horse contact lists (new horses start without contacts).
+void ContactTable::setHorseQuantity(int quantity)
+{
+	firstContact.resize(quantity, -1);
+	lastContact.resize(quantity, -1);
+	contactQuantity.resize(quantity, 0);
+}
+
+//Both horses of a pair map to the same key no matter the order they're given in.
+unsigned long long ContactTable::getKey(int horse1, int horse2)
+{
+	if (horse1 > horse2)
+		swap(horse1, horse2);
+	return ((unsigned long long)horse1 << 32) | (unsigned int)horse2;
+}
+
+//Which of the contact's two lists belongs to the horse.
+int ContactTable::getSide(int contact, int horse)
+{
+	return contacts[contact].horse1 == horse ? 0 : 1;
+}
+
+//Append the contact to the end of the horse's list (it's the horse's newest contact).
+void ContactTable::link(int contact, int horse)
+{
+	int side = getSide(contact, horse);
+	contacts[contact].previous[side] = lastContact[horse];
+	contacts[contact].next[side] = -1;
+	if (lastContact[horse] != -1)
+		contacts[lastContact[horse]].next[getSide(lastContact[horse], horse)] = contact;
+	else
+		firstContact[horse] = contact;
+	lastContact[horse] = contact;
+	contactQuantity[horse]++;
+}
+
+//Take the contact out of the horse's list.
+void ContactTable::unlink(int contact, int horse)
+{
+	int side = getSide(contact, horse);
+	int previous = contacts[contact].previous[side];
+	int next = contacts[contact].next[side];
+	if (previous != -1)
+		contacts[previous].next[getSide(previous, horse)] = next;
+	else
+		firstContact[horse] = next;
+	if (next != -1)
+		contacts[next].previous[getSide(next, horse)] = previous;
+	else
+		lastContact[horse] = previous;
+	contactQuantity[horse]--;
+}
+
+//Turn this frame's collided pairs (sorted, smaller index first) into events sorted the same way. Collided pairs that
+//aren't in the table yet begin, the ones that are persist and contacts that weren't collided this frame end. Only
+//contacts that exist are visited to find the ones that ended. Beginning and ending contacts are left to the caller to
+//add/remove so it can do so in the order it handles the events.
+void ContactTable::update(const vector<pair<int, int> > &collidedPairs, vector<ContactEvent> &events)
+{
+	frame++;
+	events.clear();
+	for (int i = 0; i < collidedPairs.size(); i++) {
+		ContactEvent event = { collidedPairs[i].first, collidedPairs[i].second, contactBegin };
+		unordered_map<unsigned long long, int>::iterator found = lookup.find(getKey(event.horse1, event.horse2));
+		if (found != lookup.end()) {
+			contacts[found->second].lastFrame = frame;
+			event.type = contactPersist;
+		}
+		events.push_back(event);
+	}
+
+	endedContacts.clear();
+	for (int i = 0; i < contacts.size(); i++)
+		if (contacts[i].horse1 != -1 && contacts[i].lastFrame != frame) {
+			ContactEvent event = { min(contacts[i].horse1, contacts[i].horse2), max(contacts[i].horse1, contacts[i].horse2), contactEnd };
+			endedContacts.push_back(event);
+		}
+	if (endedContacts.empty())
+		return;
+
+	//Merge the ended contacts in with the rest of the events.
+	sort(endedContacts.begin(), endedContacts.end(), isEarlierPair);
+	int collidedQuantity = events.size();
+	events.insert(events.end(), endedContacts.begin(), endedContacts.end());
+	inplace_merge(events.begin(), events.begin() + collidedQuantity, events.end(), isEarlierPair);
+}
+
+//Start a contact between two horses (it becomes the newest contact of both).
+void ContactTable::addContact(int horse1, int horse2)
+{
+	int contact;
+	if (!freeContacts.empty()) {
+		contact = freeContacts.back();
+		freeContacts.pop_back();
+	}
+	else {
+		contact = contacts.size();
+		contacts.push_back(Contact());
+	}
+	contacts[contact].horse1 = horse1;
+	contacts[contact].horse2 = horse2;
+	contacts[contact].lastFrame = frame;
+	link(contact, horse1);
+	link(contact, horse2);
+	lookup[getKey(horse1, horse2)] = contact;
+}
+
+//End the contact between two horses if they have one.
+void ContactTable::removeContact(int horse1, int horse2)
+{
+	unordered_map<unsigned long long, int>::iterator found = lookup.find(getKey(horse1, horse2));
+	if (found == lookup.end())
+		return;
+	int contact = found->second;
+	unlink(contact, contacts[contact].horse1);
+	unlink(contact, contacts[contact].horse2);
+	contacts[contact].horse1 = -1;
+	freeContacts.push_back(contact);
+	lookup.erase(found);
+}
+
+//GETTERS
+int ContactTable::getContactQuantity(int horse)
+{
+	return contactQuantity[horse];
+}
+
+//The horse this horse has been collided with the longest (-1 if none).
+int ContactTable::getOldestContact(int horse)
+{
+	int contact = firstContact[horse];
+	if (contact == -1)
+		return -1;
+	return contacts[contact].horse1 == horse ? contacts[contact].horse2 : contacts[contact].horse1;
+}
\ No newline at end of file
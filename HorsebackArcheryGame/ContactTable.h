@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+using namespace std;
+
+enum contactEventType { contactBegin, contactPersist, contactEnd };
+
+//Something that happened to a pair of horses this frame (horse1 is always the smaller index).
+struct ContactEvent {
+	int horse1;
+	int horse2;
+	contactEventType type;
+};
+
+//Every pair of horses currently collided with each other, keyed by the pair. Each contact remembers the last frame it was
+//detected in, so contacts that weren't detected this frame are the ones that ended. Each horse also keeps its contacts in
+//the order they started (a linked list through the contacts), which gives the horse it collided with first.
+class ContactTable {
+	private:
+		struct Contact {
+			int horse1;          //-1 if the slot is free.
+			int horse2;
+			int lastFrame;       //Last frame the pair was detected as collided.
+			int next[2];         //Next/previous contact in the lists of horse1 (index 0) and horse2 (index 1).
+			int previous[2];
+		};
+
+		int frame;
+		vector<Contact> contacts;
+		vector<int> freeContacts;                       //Slots of contacts that ended (reused by new contacts).
+		unordered_map<unsigned long long, int> lookup;  //Pair to slot.
+		vector<int> firstContact;                       //Per horse: oldest contact...
+		vector<int> lastContact;                        //...newest contact...
+		vector<int> contactQuantity;                    //...and how many contacts.
+		vector<ContactEvent> endedContacts;
+
+		unsigned long long getKey(int horse1, int horse2);
+		int getSide(int contact, int horse);
+		void link(int contact, int horse);
+		void unlink(int contact, int horse);
+	public:
+		ContactTable();
+		void setHorseQuantity(int quantity);
+		void update(const vector<pair<int, int> > &collidedPairs, vector<ContactEvent> &events);
+		void addContact(int horse1, int horse2);
+		void removeContact(int horse1, int horse2);
+
+		//GETTERS
+		int getContactQuantity(int horse);
+		int getOldestContact(int horse);
+};
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "CounterRandom.h"
+#include "HorseHerd.h"      //For the HORSE_SIMD_ macros.
+
+#if defined(HORSE_SIMD_AVX) || defined(HORSE_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+//Maps a 32-bit value to min to max (both included) by scaling instead of taking a remainder, which keeps every result
+//almost equally likely for small ranges.
+int CounterRandom::toRange(unsigned int value, int min, int max)
+{
+	unsigned long long range = (unsigned long long)(max - min) + 1;
+	return min + (int)((value * range) >> 32);
+}
+
+//Philox4x32-10: the counter is (block, tick, 0, 0) and the key is (seed, stream).
+void CounterRandom::generateBlock(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int block, unsigned int* values)
+{
+	unsigned int counter0 = block, counter1 = tick, counter2 = 0, counter3 = 0;
+	unsigned int key0 = seed, key1 = stream;
+	for (int round = 0; round < ROUNDS; round++) {
+		unsigned long long product0 = (unsigned long long)MULTIPLIER0 * counter0;
+		unsigned long long product1 = (unsigned long long)MULTIPLIER1 * counter2;
+		counter0 = (unsigned int)(product1 >> 32) ^ counter1 ^ key0;
+		counter1 = (unsigned int)product1;
+		counter2 = (unsigned int)(product0 >> 32) ^ counter3 ^ key1;
+		counter3 = (unsigned int)product0;
+		key0 += WEYL0;
+		key1 += WEYL1;
+	}
+	values[0] = counter0;
+	values[1] = counter1;
+	values[2] = counter2;
+	values[3] = counter3;
+}
+
+unsigned int CounterRandom::generate(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int draw)
+{
+	unsigned int values[4];
+	generateBlock(seed, stream, tick, draw / 4, values);
+	return values[draw % 4];
+}
+
+int CounterRandom::uniformInt(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int draw, int min, int max)
+{
+	return toRange(generate(seed, stream, tick, draw), min, max);
+}
+
+#if defined(HORSE_SIMD_AVX) || defined(HORSE_SIMD_SSE)
+//Multiplies each 32-bit lane by the same constant, giving the low and high halves of the four 64-bit products.
+static inline void multiplyLanes(__m128i lanes, __m128i multiplier, __m128i &low, __m128i &high)
+{
+	__m128i evenProducts = _mm_mul_epu32(lanes, multiplier);                      //Lanes 0 and 2.
+	__m128i oddProducts = _mm_mul_epu32(_mm_srli_epi64(lanes, 32), multiplier);   //Lanes 1 and 3.
+	low = _mm_unpacklo_epi32(_mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(0, 0, 2, 0)));
+	high = _mm_unpacklo_epi32(_mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+//Four consecutive blocks at once, one per lane, written out in draw order (16 values).
+void CounterRandom::generateFourBlocks(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstBlock, unsigned int* values)
+{
+	const __m128i multiplier0 = _mm_set1_epi32((int)MULTIPLIER0);
+	const __m128i multiplier1 = _mm_set1_epi32((int)MULTIPLIER1);
+	__m128i counter0 = _mm_add_epi32(_mm_set1_epi32((int)firstBlock), _mm_set_epi32(3, 2, 1, 0));
+	__m128i counter1 = _mm_set1_epi32((int)tick);
+	__m128i counter2 = _mm_setzero_si128();
+	__m128i counter3 = _mm_setzero_si128();
+	unsigned int key0 = seed, key1 = stream;
+	for (int round = 0; round < ROUNDS; round++) {
+		__m128i low0, high0, low1, high1;
+		multiplyLanes(counter0, multiplier0, low0, high0);
+		multiplyLanes(counter2, multiplier1, low1, high1);
+		counter0 = _mm_xor_si128(_mm_xor_si128(high1, counter1), _mm_set1_epi32((int)key0));
+		counter1 = low1;
+		counter2 = _mm_xor_si128(_mm_xor_si128(high0, counter3), _mm_set1_epi32((int)key1));
+		counter3 = low0;
+		key0 += WEYL0;
+		key1 += WEYL1;
+	}
+
+	//Transpose so each block's four values end up next to each other.
+	__m128i blocks01Low = _mm_unpacklo_epi32(counter0, counter1);
+	__m128i blocks23Low = _mm_unpackhi_epi32(counter0, counter1);
+	__m128i blocks01High = _mm_unpacklo_epi32(counter2, counter3);
+	__m128i blocks23High = _mm_unpackhi_epi32(counter2, counter3);
+	_mm_storeu_si128((__m128i*)&values[0], _mm_unpacklo_epi64(blocks01Low, blocks01High));
+	_mm_storeu_si128((__m128i*)&values[4], _mm_unpackhi_epi64(blocks01Low, blocks01High));
+	_mm_storeu_si128((__m128i*)&values[8], _mm_unpacklo_epi64(blocks23Low, blocks23High));
+	_mm_storeu_si128((__m128i*)&values[12], _mm_unpackhi_epi64(blocks23Low, blocks23High));
+}
+#endif
+
+void CounterRandom::fill(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstDraw, int quantity, unsigned int* values)
+{
+	unsigned int blockValues[16];
+	int i = 0;
+	while (i < quantity) {
+		unsigned int draw = firstDraw + i;
+		int offset = draw % 4;
+		int available;
+#if defined(HORSE_SIMD_AVX) || defined(HORSE_SIMD_SSE)
+		if (quantity - i >= 16 - offset) {
+			generateFourBlocks(seed, stream, tick, draw / 4, blockValues);
+			available = 16 - offset;
+		}
+		else
+#endif
+		{
+			generateBlock(seed, stream, tick, draw / 4, blockValues);
+			available = 4 - offset;
+		}
+		for (int j = 0; j < available && i < quantity; j++, i++)
+			values[i] = blockValues[offset + j];
+	}
+}
+
+void CounterRandom::fillUniformInts(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstDraw, int quantity, int min, int max, int* values)
+{
+	fill(seed, stream, tick, firstDraw, quantity, (unsigned int*)values);
+	for (int i = 0; i < quantity; i++)
+		values[i] = toRange((unsigned int)values[i], min, max);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+//Stateless random numbers: every value is a function of a seed, a stream (e.g. a horse), a tick and which draw it is in
+//that tick, computed with the Philox4x32-10 counter-based generator. There's no hidden state to share between threads,
+//so anything drawing this way gives the same numbers for a given seed whatever thread it runs on, in whatever order.
+//Each Philox block gives 4 values, so draws 0-3 of a tick come from block 0, draws 4-7 from block 1 and so on.
+class CounterRandom {
+	private:
+		static const unsigned int MULTIPLIER0 = 0xD2511F53;
+		static const unsigned int MULTIPLIER1 = 0xCD9E8D57;
+		static const unsigned int WEYL0 = 0x9E3779B9;      //Added to the key after every round.
+		static const unsigned int WEYL1 = 0xBB67AE85;
+		static const int ROUNDS = 10;
+
+		static int toRange(unsigned int value, int min, int max);
+		static void generateFourBlocks(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstBlock, unsigned int* values);  //SSE2 only.
+	public:
+		static void generateBlock(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int block, unsigned int* values);
+		static unsigned int generate(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int draw);
+		static int uniformInt(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int draw, int min, int max);
+
+		//Batched versions: the same values as calling the ones above for draws firstDraw to firstDraw + quantity - 1, with
+		//four blocks generated at a time using SSE2 where available.
+		static void fill(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstDraw, int quantity, unsigned int* values);
+		static void fillUniformInts(unsigned int seed, unsigned int stream, unsigned int tick, unsigned int firstDraw, int quantity, int min, int max, int* values);
+};
\ No newline at end of file
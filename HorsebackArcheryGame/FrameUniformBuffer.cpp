@@ -0,0 +1,43 @@
+#include "FrameUniformBuffer.h"
+#include <cstring>
+
+FrameUniformBuffer::FrameUniformBuffer()
+{
+	isUploaded = false;
+	uploadQuantity = 0;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, buffer);
+}
+
+//Let a program read its FrameConstants block from this buffer (GLSL 330 can't set the binding point in the shader).
+//Programs that don't use the block are left alone.
+void FrameUniformBuffer::attach(GLuint program)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(program, "FrameConstants");
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, blockIndex, BINDING_POINT);
+}
+
+//Write the constants of this frame, unless they are the same as last frame's (a still camera).
+void FrameUniformBuffer::update(const FrameConstants& constants)
+{
+	if (isUploaded && memcmp(&uploaded, &constants, sizeof(FrameConstants)) == 0)
+		return;
+
+	uploaded = constants;
+	isUploaded = true;
+	uploadQuantity++;
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &uploaded);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//GETTERS
+int FrameUniformBuffer::getUploadQuantity()
+{
+	return uploadQuantity;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "..\glew\glew.h"	//include GL Extension Wrangler
+#include "..\glfw\glfw3.h"	//include GLFW helper library
+#include "glm.hpp"
+
+//Mirror of the FrameConstants uniform block of the shaders in std140 layout. vec3 values take a whole vec4 in std140,
+//so they are stored as vec4 and the shaders only read xyz.
+struct FrameConstants {
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
+	glm::mat4 shadowViewMatrix;
+	glm::mat4 shadowProjectionMatrix;
+	glm::vec4 lightColor;
+	glm::vec4 lightPosition;
+	glm::vec4 viewPosition;    //Influences specular lighting.
+};
+
+//Uniform buffer holding the camera, light and shadow values every program of a frame shares. Programs are attached
+//once and read it through their FrameConstants block, so a value is uploaded once for all of them instead of once per
+//program. The buffer is only written when a value changed since the last frame.
+class FrameUniformBuffer {
+	private:
+		static const GLuint BINDING_POINT = 0;
+
+		GLuint buffer;
+		FrameConstants uploaded;   //What the buffer holds.
+		bool isUploaded;           //Whether anything was uploaded yet.
+		int uploadQuantity;
+	public:
+		FrameUniformBuffer();
+		void attach(GLuint program);
+		void update(const FrameConstants& constants);
+
+		//GETTERS
+		int getUploadQuantity();
+};
\ No newline at end of file
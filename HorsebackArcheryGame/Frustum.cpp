@@ -0,0 +1,34 @@
+#include "Frustum.h"
+
+//A frustum that sees everything.
+Frustum::Frustum()
+{
+	for (int i = 0; i < 6; i++)
+		planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+//Clip space keeps -w <= x, y, z <= w, so every plane is the last row of the matrix plus or minus one of the others.
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	for (int i = 0; i < 3; i++) {
+		planes[2 * i] = rows[3] + rows[i];
+		planes[2 * i + 1] = rows[3] - rows[i];
+	}
+	for (int i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+//Whether any part of a sphere (xyz center, w radius) can be inside. Spheres near a corner can pass without being
+//inside, which only costs drawing something that's off screen.
+bool Frustum::isSphereVisible(const glm::vec4& sphere)
+{
+	glm::vec3 center = glm::vec3(sphere);
+	for (int i = 0; i < 6; i++)
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -sphere.w)
+			return false;
+	return true;
+}
\ No newline at end of file
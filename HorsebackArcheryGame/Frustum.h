@@ -0,0 +1,14 @@
+#pragma once
+
+#include "glm.hpp"
+
+//The volume a camera sees, as six planes pointing inward. Built from the camera's projection*view matrix, so the same
+//test works for the window camera and the light the shadow map is rendered from.
+class Frustum {
+	private:
+		glm::vec4 planes[6];  //xyz is the unit normal, w the distance, so a point p is inside a plane when dot(xyz, p) + w >= 0.
+	public:
+		Frustum();
+		Frustum(const glm::mat4& viewProjection);
+		bool isSphereVisible(const glm::vec4& sphere);
+};
\ No newline at end of file
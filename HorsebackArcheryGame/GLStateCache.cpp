@@ -0,0 +1,146 @@
+#include "GLStateCache.h"
+#include <cstring>
+#include "gtc/type_ptr.hpp"
+
+GLStateCache::GLStateCache()
+{
+	issuedCalls = 0;
+	skippedCalls = 0;
+	lastFrameIssuedCalls = 0;
+	lastFrameSkippedCalls = 0;
+	invalidate();
+}
+
+//Forget everything so the next call of each kind is sent to GL again.
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeTextureUnit = UNKNOWN;
+	for (int i = 0; i < TEXTURE_UNITS; i++)
+		boundTextures[i] = UNKNOWN;
+	uniforms.clear();
+}
+
+//Keep the counts of the frame that just ended and start counting the next one.
+void GLStateCache::markFrame()
+{
+	lastFrameIssuedCalls = issuedCalls;
+	lastFrameSkippedCalls = skippedCalls;
+	issuedCalls = 0;
+	skippedCalls = 0;
+}
+
+void GLStateCache::useProgram(GLuint programParam)
+{
+	if (program == programParam) {
+		skippedCalls++;
+		return;
+	}
+	program = programParam;
+	glUseProgram(program);
+	issuedCalls++;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArrayParam)
+{
+	if (vertexArray == vertexArrayParam) {
+		skippedCalls++;
+		return;
+	}
+	vertexArray = vertexArrayParam;
+	glBindVertexArray(vertexArray);
+	issuedCalls++;
+}
+
+//unit is GL_TEXTURE0, GL_TEXTURE1...
+void GLStateCache::activeTexture(GLenum unit)
+{
+	if (activeTextureUnit == unit) {
+		skippedCalls++;
+		return;
+	}
+	activeTextureUnit = unit;
+	glActiveTexture(unit);
+	issuedCalls++;
+}
+
+//Bind a 2D texture to a texture unit. The active unit is only switched when the binding actually changes.
+void GLStateCache::bindTexture(GLenum unit, GLuint texture)
+{
+	int index = unit - GL_TEXTURE0;
+	if (boundTextures[index] == texture) {
+		skippedCalls++;
+		return;
+	}
+	activeTexture(unit);
+	boundTextures[index] = texture;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	issuedCalls++;
+}
+
+//Compare a uniform of the program in use (set through useProgram() first) with what it was last set to and remember the new value.
+//Locations of -1 (uniforms the compiler optimized out) are ignored by GL anyway, so they count as skipped.
+bool GLStateCache::isUniformChanged(GLint location, const GLfloat* values, int size)
+{
+	if (location == -1) {
+		skippedCalls++;
+		return false;
+	}
+
+	unsigned long long key = ((unsigned long long)program << 32) | (unsigned int)location;
+	unordered_map<unsigned long long, UniformValue>::iterator cached = uniforms.find(key);
+	if (cached != uniforms.end() && cached->second.size == size && memcmp(cached->second.values, values, size*sizeof(GLfloat)) == 0) {
+		skippedCalls++;
+		return false;
+	}
+
+	UniformValue& value = uniforms[key];
+	memcpy(value.values, values, size*sizeof(GLfloat));
+	value.size = size;
+	issuedCalls++;
+	return true;
+}
+
+void GLStateCache::setUniform(GLint location, GLint value)
+{
+	GLfloat bits;
+	memcpy(&bits, &value, sizeof(GLint));
+	if (isUniformChanged(location, &bits, 1))
+		glUniform1i(location, value);
+}
+
+void GLStateCache::setUniform(GLint location, const glm::vec3& value)
+{
+	if (isUniformChanged(location, glm::value_ptr(value), 3))
+		glUniform3fv(location, 1, glm::value_ptr(value));
+}
+
+void GLStateCache::setUniform(GLint location, const glm::vec4& value)
+{
+	if (isUniformChanged(location, glm::value_ptr(value), 4))
+		glUniform4fv(location, 1, glm::value_ptr(value));
+}
+
+void GLStateCache::setUniform(GLint location, const glm::mat3& value)
+{
+	if (isUniformChanged(location, glm::value_ptr(value), 9))
+		glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GLStateCache::setUniform(GLint location, const glm::mat4& value)
+{
+	if (isUniformChanged(location, glm::value_ptr(value), 16))
+		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+//GETTERS
+int GLStateCache::getLastFrameIssuedCalls()
+{
+	return lastFrameIssuedCalls;
+}
+
+int GLStateCache::getLastFrameSkippedCalls()
+{
+	return lastFrameSkippedCalls;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_map>
+#include "..\glew\glew.h"	//include GL Extension Wrangler
+#include "..\glfw\glfw3.h"	//include GLFW helper library
+#include "glm.hpp"
+
+using namespace std;
+
+//Last value a uniform was set to. Ints are stored bit for bit in the floats.
+struct UniformValue {
+	GLfloat values[16];
+	int size;            //Floats in use.
+};
+
+//Remembers the program, VAO, texture bindings and uniform values last sent to GL so the render loop can set them
+//every frame without the driver seeing calls that change nothing. Every bind and uniform of the render loop has to go
+//through it, otherwise what it remembers is no longer what GL has. Call invalidate() after touching GL state directly.
+class GLStateCache {
+	private:
+		static const int TEXTURE_UNITS = 16;
+		static const GLuint UNKNOWN = 0xFFFFFFFF;  //State not set through the cache yet (the first call always goes out).
+
+		GLuint program;
+		GLuint vertexArray;
+		GLenum activeTextureUnit;
+		GLuint boundTextures[TEXTURE_UNITS];       //GL_TEXTURE_2D binding of each unit.
+		unordered_map<unsigned long long, UniformValue> uniforms; //By program and location.
+		int issuedCalls;
+		int skippedCalls;
+		int lastFrameIssuedCalls;
+		int lastFrameSkippedCalls;
+
+		bool isUniformChanged(GLint location, const GLfloat* values, int size);
+	public:
+		GLStateCache();
+		void invalidate();
+		void markFrame();
+		void useProgram(GLuint programParam);
+		void bindVertexArray(GLuint vertexArrayParam);
+		void activeTexture(GLenum unit);
+		void bindTexture(GLenum unit, GLuint texture);
+		void setUniform(GLint location, GLint value);
+		void setUniform(GLint location, const glm::vec3& value);
+		void setUniform(GLint location, const glm::vec4& value);
+		void setUniform(GLint location, const glm::mat3& value);
+		void setUniform(GLint location, const glm::mat4& value);
+
+		//GETTERS
+		int getLastFrameIssuedCalls();
+		int getLastFrameSkippedCalls();
+};
\ No newline at end of file
@@ -0,0 +1,514 @@
+#include <math.h>           //For fabs() function.
+#include <algorithm>        //For min() and max() functions.
+#include "GaitTable.h"
+
+//Joints of each channel (the same pairs the procedural animation steps together).
+const int GaitTable::CHANNEL_JOINTS[CHANNEL_QUANTITY][2] = { { 2, 3 }, { 6, 7 }, { 4, 5 }, { 8, 9 }, { 0, 1 } };
+
+GaitTable::GaitTable(animation gaitParam)
+{
+	gait = gaitParam;
+	bake();
+}
+
+//Tables of every gait, baked the first time any of them is needed (the first horse is spawned before any threads use
+//them).
+GaitTable* GaitTable::getTable(animation gait)
+{
+	static GaitTable runTable(run);
+	static GaitTable walkTable(walk);
+	static GaitTable jumpTable(jump);
+	if (gait == run)
+		return &runTable;
+	else if (gait == walk)
+		return &walkTable;
+	else
+		return &jumpTable;
+}
+
+//Phase of the frame after the given one. Phases wrap around once every channel is back at the start of its loop, so
+//they stay small however long a horse keeps the same gait.
+int GaitTable::advance(int phase)
+{
+	phase++;
+	if (phase == loopStart + loopLength)
+		phase = loopStart;
+	return phase;
+}
+
+//Step the procedural animation from its setup, then find the loop of every channel in the frames.
+void GaitTable::bake()
+{
+	vector<float> bakedFrames;
+	setup();
+	for (int frame = 0; frame < BAKE_FRAMES; frame++) {
+		bakedFrames.insert(bakedFrames.end(), jointAngles, jointAngles + JOINT_QUANTITY);
+		step();
+	}
+
+	loopStart = 0;
+	long long commonLength = 1;
+	for (int i = 0; i < CHANNEL_QUANTITY; i++) {
+		channels[i].joints[0] = CHANNEL_JOINTS[i][0];
+		channels[i].joints[1] = CHANNEL_JOINTS[i][1];
+		findLoop(bakedFrames, channels[i]);
+		loopStart = max(loopStart, channels[i].loopStart);
+		long long a = commonLength, b = channels[i].loopLength;
+		while (b != 0) {
+			long long remainder = a % b;
+			a = b;
+			b = remainder;
+		}
+		commonLength = min(commonLength / a * channels[i].loopLength, (long long)MAX_PHASE_LOOP);
+	}
+	loopLength = (int)commonLength;
+}
+
+//Keep the channel's angles up to the end of the shortest loop in the frames (a stretch of frames that the channel goes
+//through again right after it). If there is none, the channel loops over every baked frame.
+void GaitTable::findLoop(const vector<float> &bakedFrames, Channel &channel)
+{
+	channel.loopStart = 0;
+	channel.loopLength = BAKE_FRAMES;
+	for (int length = 1; 2 * length <= BAKE_FRAMES && channel.loopLength == BAKE_FRAMES; length++)
+		for (int start = 0; start < LOOP_SEARCH_FRAMES && start + 2 * length <= BAKE_FRAMES; start++)
+			if (isRepeated(bakedFrames, channel, start, length)) {
+				channel.loopStart = start;
+				channel.loopLength = length;
+				break;
+			}
+
+	channel.frames.clear();
+	for (int frame = 0; frame < channel.loopStart + channel.loopLength; frame++) {
+		channel.frames.push_back(bakedFrames[frame*JOINT_QUANTITY + channel.joints[0]]);
+		channel.frames.push_back(bakedFrames[frame*JOINT_QUANTITY + channel.joints[1]]);
+	}
+}
+
+//Check if the channel's angles of the length frames from start come again right after (within LOOP_TOLERANCE).
+bool GaitTable::isRepeated(const vector<float> &bakedFrames, const Channel &channel, int start, int length)
+{
+	for (int frame = start; frame < start + length; frame++)
+		for (int i = 0; i < 2; i++) {
+			float angle = bakedFrames[frame*JOINT_QUANTITY + channel.joints[i]];
+			float repeatedAngle = bakedFrames[(frame + length)*JOINT_QUANTITY + channel.joints[i]];
+			if (fabs(angle - repeatedAngle) > LOOP_TOLERANCE)
+				return false;
+		}
+	return true;
+}
+
+//Initial joint properties of the gait.
+void GaitTable::setup()
+{
+	if (gait == walk)
+		walkAnimationSetup();
+	else if (gait == run)
+		runAnimationSetup();
+	else
+		jumpAnimationSetup();
+}
+
+//Advance the procedural animation by one frame.
+void GaitTable::step()
+{
+	if (gait == walk)
+		walkAnimation();
+	else if (gait == run)
+		runAnimation();
+	else
+		jumpAnimation();
+}
+
+//RUN ANIMATION
+//Execute run animation for all body parts.
+void GaitTable::runAnimation()
+{
+	runArmAnimation(2, 3);
+	runArmAnimation(6, 7);
+	runLegAnimation(4, 5);
+	runLegAnimation(8, 9);
+	runNeckAnimation(0, 1);
+}
+
+//Initial joint properties before run animation starts.
+void GaitTable::runAnimationSetup()
+{
+	for (int i = 0; i < 10; i++) {
+		jointAngles[i] = 0.0f;
+		jointSpeed[i] = 1.0f;
+		jointDirection[i] = 1.0f;
+	}
+
+	jointAngles[0] = -PI / 6;
+	jointAngles[1] = -PI / 8;
+	jointAngles[7] = -PI / 5;
+	jointAngles[5] = PI / 3;
+	jointAngles[9] = PI / 3 - PI / 5;
+	jointSpeed[4] = 2.5f;
+	jointSpeed[8] = 2.5f;
+	jointDirection[4] = -1.0f;
+	jointDirection[8] = -1.0f;
+}
+
+//Specific changes between angles, speed and direction to properly execute run animation for horse arms.
+void GaitTable::runArmAnimation(int lowerLimb, int upperLimb)
+{
+	if (jointAngles[upperLimb] < -PI / 3) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+	if (jointAngles[upperLimb] > PI / 18) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+		jointAngles[lowerLimb] = PI / 2;
+		jointSpeed[lowerLimb] = 1.1f;
+	}
+
+	if (jointAngles[upperLimb] < -PI / 36) {
+		jointSpeed[upperLimb] = 1.0f;
+	}
+	else {
+		jointSpeed[upperLimb] = 0.5f;
+		if (jointDirection[lowerLimb] == 1.0f)
+			jointSpeed[lowerLimb] = 5.0f;
+	}
+
+	if (jointAngles[lowerLimb] > PI / 2) {
+		jointAngles[lowerLimb] = PI / 2;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute run animation for horse legs.
+void GaitTable::runLegAnimation(int lowerLimb, int upperLimb)
+{
+	if (jointAngles[upperLimb] > PI / 3) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+		jointSpeed[lowerLimb] = 2.5f;
+	}
+
+	if (jointAngles[upperLimb] < 0) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+		jointSpeed[lowerLimb] = 2.5f;
+	}
+
+	if (jointAngles[upperLimb] < PI / 18) {
+		jointSpeed[upperLimb] = 0.5f;
+	}
+	else
+		jointSpeed[upperLimb] = 1.0f;
+
+	if (jointAngles[lowerLimb] < -PI / 2) {
+		jointAngles[lowerLimb] = -PI / 2;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+	if (jointAngles[lowerLimb] > 0) {
+		jointAngles[lowerLimb] = 0;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute run animation for horse's head and neck.
+void GaitTable::runNeckAnimation(int head, int neck)
+{
+	if (jointAngles[neck] > PI / 30)
+	{
+		jointDirection[neck] = -1.0f;
+		jointSpeed[neck] = 0.25f;
+		jointDirection[head] = -1.0f;
+		jointSpeed[head] = 0.25f;
+	}
+	if (jointAngles[neck] < -PI / 8)
+	{
+		jointDirection[neck] = 1.0f;
+		jointSpeed[neck] = 0.5f;
+		jointDirection[head] = 1.0f;
+		jointSpeed[head] = 0.5f;
+	}
+	if (jointAngles[head] > 0.0f) {
+		jointAngles[head] = 0.0f;
+	}
+	if (jointAngles[head] < -PI / 6) {
+		jointAngles[head] = -PI / 6;
+	}
+	jointAngles[neck] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
+	jointAngles[head] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
+}
+
+//WALK ANIMATION
+//Execute walk animation for all body parts.
+void GaitTable::walkAnimation() {
+	walkArmAnimation(2, 3);
+	walkArmAnimation(6, 7);
+	walkLegAnimation(4, 5);
+	walkLegAnimation(8, 9);
+	walkNeckAnimation(0, 1);
+}
+
+//Initial joint properties before walk animation starts.
+void GaitTable::walkAnimationSetup() {
+	for (int i = 0; i < 10; i++) {
+		jointAngles[i] = 0.0f;
+		jointSpeed[i] = 1.0f;
+		jointDirection[i] = 1.0f;
+	}
+
+	jointAngles[2] = PI / 36;
+	jointDirection[2] = -1.0f;
+	jointDirection[3] = 1.0f;
+	jointSpeed[3] = 3.0f;
+	jointAngles[6] = -PI / 6;
+	jointDirection[6] = 1.0f;
+	jointDirection[7] = -1.0f;
+	jointSpeed[7] = 1.5f;
+	jointAngles[4] = -PI / 36;
+	jointDirection[4] = 1.0f;
+	jointDirection[5] = -1.0f;
+	jointSpeed[5] = 1.5f;
+	jointAngles[8] = PI / 6;
+	jointDirection[8] = -1.0f;
+	jointDirection[9] = 1.0f;
+	jointSpeed[9] = 3.0f;
+}
+
+//Specific changes between angles, speed and direction to properly execute walk animation for horse arms.
+void GaitTable::walkArmAnimation(int lowerLimb, int upperLimb) {
+	if (jointAngles[upperLimb] < -PI / 6) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+		jointSpeed[lowerLimb] = 1.5f;
+	}
+	if (jointAngles[upperLimb] > PI / 36) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+		jointSpeed[lowerLimb] = 3.0f;
+	}
+
+	if (jointAngles[upperLimb] < 0)
+		jointSpeed[upperLimb] = 1.0f;
+	else
+		jointSpeed[upperLimb] = 0.2f;
+
+	if (jointAngles[lowerLimb] > PI / 4) {
+		jointAngles[lowerLimb] = PI / 4;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+	if (jointAngles[lowerLimb] < 0) {
+		jointAngles[lowerLimb] = 0.0f;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute walk animation for horse legs.
+void GaitTable::walkLegAnimation(int lowerLimb, int upperLimb) {
+	if (jointAngles[upperLimb] < -PI / 36) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+		jointSpeed[lowerLimb] = 1.5f;
+	}
+	if (jointAngles[upperLimb] > PI / 6) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+		jointSpeed[lowerLimb] = 3.0f;
+	}
+
+	if (jointAngles[upperLimb] > 0)
+		jointSpeed[upperLimb] = 1.0f;
+	else
+		jointSpeed[upperLimb] = 0.2f;
+
+	if (jointAngles[lowerLimb] > PI / 4) {
+		jointAngles[lowerLimb] = PI / 4;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+	if (jointAngles[lowerLimb] < 0) {
+		jointAngles[lowerLimb] = 0.0f;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute walk animation for horse's head and neck.
+void GaitTable::walkNeckAnimation(int head, int neck) {
+	if (jointAngles[neck] > PI / 45)
+	{
+		jointDirection[neck] = -1.0f;
+		jointSpeed[neck] = 0.25f;
+		jointDirection[head] = -1.0f;
+		jointSpeed[head] = 0.25f;
+	}
+	if (jointAngles[neck] < -PI / 30)
+	{
+		jointDirection[neck] = 1.0f;
+		jointSpeed[neck] = 0.5f;
+		jointDirection[head] = 1.0f;
+		jointSpeed[head] = 0.5f;
+	}
+	if (jointAngles[head] > 0.0f) {
+		jointAngles[head] = 0.0f;
+	}
+	if (jointAngles[head] < -PI / 6) {
+		jointAngles[head] = -PI / 6;
+	}
+	jointAngles[neck] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
+	jointAngles[head] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
+}
+
+//JUMP ANIMATION
+//Execute jump animation for all body parts.
+void GaitTable::jumpAnimation() {
+	jumpArmAnimation(2, 3);
+	jumpArmAnimation(6, 7);
+	jumpLegAnimation(4, 5);
+	jumpLegAnimation(8, 9);
+	jumpNeckAnimation(0, 1);
+}
+
+//Initial joint properties before jump animation starts.
+void GaitTable::jumpAnimationSetup() {
+	for (int i = 0; i < 10; i++) {
+		jointAngles[i] = 0.0f;
+		jointSpeed[i] = 1.0f;
+		jointDirection[i] = 1.0f;
+	}
+
+	jointSpeed[5] = 0.0f;
+	jointDirection[5] = -1.0f;
+	jointSpeed[9] = 0.0f;
+	jointDirection[9] = -1.0f;
+}
+
+//Specific changes between angles, speed and direction to properly execute jump animation for horse arms.
+void GaitTable::jumpArmAnimation(int lowerLimb, int upperLimb) {
+	if (jointAngles[upperLimb] < -PI / 3) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+	}
+	if (jointAngles[upperLimb] > 0) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+		jointSpeed[lowerLimb] = 2.0f;
+	}
+
+	if (jointAngles[upperLimb] > -PI / 4) {
+		jointSpeed[upperLimb] = 1.5f;
+		if (jointDirection[lowerLimb] == -1.0f && jointAngles[lowerLimb] > 0.0f)
+			jointSpeed[lowerLimb] = 5.0f;
+	}
+	else
+		jointSpeed[upperLimb] = 0.2f;
+
+	if (jointAngles[lowerLimb] > 5* PI / 8) {
+		jointAngles[lowerLimb] = 5 * PI / 8;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+	if (jointAngles[lowerLimb] < 0) {
+		jointAngles[lowerLimb] = 0.0f;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute jump animation for horse legs.
+void GaitTable::jumpLegAnimation(int lowerLimb, int upperLimb) {
+	if (jointAngles[upperLimb] < 0) {
+		jointDirection[upperLimb] = 1.0f;
+		jointDirection[lowerLimb] = 1.0f;
+	}
+	if (jointAngles[upperLimb] > PI / 3) {
+		jointDirection[upperLimb] = -1.0f;
+		jointDirection[lowerLimb] = -1.0f;
+		jointSpeed[lowerLimb] = 2.5f;
+	}
+
+	if (jointAngles[upperLimb] < PI / 4) {
+		jointSpeed[upperLimb] = 1.5f;
+		if (jointDirection[upperLimb] == 1.0f)
+			jointSpeed[lowerLimb] = 0.0f;
+	}
+	else
+		jointSpeed[upperLimb] = 0.2f;
+
+	if (jointAngles[lowerLimb] < -5 * PI / 8) {
+		jointAngles[lowerLimb] = -5 * PI / 8;
+		jointDirection[lowerLimb] = 1.0f;
+	}
+	if (jointAngles[lowerLimb] > 0) {
+		jointAngles[lowerLimb] = 0.0f;
+		jointSpeed[lowerLimb] = 0.0f;
+	}
+
+	jointAngles[upperLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
+	jointAngles[lowerLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+}
+
+//Specific changes between angles, speed and direction to properly execute jump animation for horse's head and neck.
+void GaitTable::jumpNeckAnimation(int head, int neck) {
+	if (jointAngles[neck] > PI / 15)
+	{
+		jointDirection[neck] = -1.0f;
+		jointSpeed[neck] = 0.125f;
+		jointDirection[head] = -1.0f;
+		jointSpeed[head] = 0.125f;
+	}
+	if (jointAngles[neck] < -PI / 40)
+	{
+		jointDirection[neck] = 1.0f;
+		jointSpeed[neck] = 0.25f;
+		jointDirection[head] = 1.0f;
+		jointSpeed[head] = 0.25f;
+	}
+	if (jointAngles[head] > 0.0f) {
+		jointAngles[head] = 0.0f;
+	}
+	if (jointAngles[head] < -PI / 6) {
+		jointAngles[head] = -PI / 6;
+	}
+	jointAngles[neck] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
+	jointAngles[head] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
+}
+
+//GETTERS
+animation GaitTable::getGait()
+{
+	return gait;
+}
+
+//Angles of every joint at the given phase, each channel at its own place in its loop.
+void GaitTable::getJointAngles(int phase, float* jointAnglesParam)
+{
+	for (int i = 0; i < CHANNEL_QUANTITY; i++) {
+		int frame = phase;
+		if (frame >= channels[i].loopStart + channels[i].loopLength)
+			frame = channels[i].loopStart + (phase - channels[i].loopStart) % channels[i].loopLength;
+		jointAnglesParam[channels[i].joints[0]] = channels[i].frames[2 * frame];
+		jointAnglesParam[channels[i].joints[1]] = channels[i].frames[2 * frame + 1];
+	}
+}
+
+int GaitTable::getLoopStart()
+{
+	return loopStart;
+}
+
+int GaitTable::getLoopLength()
+{
+	return loopLength;
+}
\ No newline at end of file
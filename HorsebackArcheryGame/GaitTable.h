@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+enum animation { run, walk, jump };
+
+//The joint angles of a gait (run, walk or jump) for every frame, baked once at startup by stepping the procedural
+//animation from its setup. The animation only depends on how many frames it ran for, so a horse just keeps its gait and
+//phase (frames since the gait started) and looks its joint angles up, and every horse at the same gait and phase shares
+//the same angles.
+//The joints are stepped in independent pairs (each limb's upper and lower joint, the neck and head), called channels
+//here, and each channel settles into its own short cycle (e.g. 27, 30 and 31 frames when running). The whole animation
+//only repeats once all of them line up, so every channel gets its own table that loops over the first stretch of frames
+//the channel goes through again right after (within LOOP_TOLERANCE, as rounding makes the angles drift a little every
+//cycle).
+class GaitTable {
+	private:
+		struct Channel {
+			int joints[2];
+			vector<float> frames;            //Both angles per frame.
+			int loopStart;                   //Frame the channel repeats from...
+			int loopLength;                  //...and how many frames it repeats every.
+		};
+
+		static const int CHANNEL_QUANTITY = 5;
+		static const int CHANNEL_JOINTS[CHANNEL_QUANTITY][2];
+		const float PI = 3.14f;
+		const float RUN_SPEED_MULTIPLIER = 6.0f;
+		const float WALK_SPEED_MULTIPLIER = 4.0f;
+		const float JUMP_SPEED_MULTIPLIER = 5.0f;
+		const int BAKE_FRAMES = 4096;          //Frames stepped when baking (a channel loops over all of them if it has no shorter loop).
+		const int LOOP_SEARCH_FRAMES = 300;    //A loop has to start within this many frames (after the channel settles in).
+		const float LOOP_TOLERANCE = 0.0001f;  //Largest difference in any angle (radians) between two goes through a loop.
+		const int MAX_PHASE_LOOP = 1 << 30;
+
+		animation gait;
+		Channel channels[CHANNEL_QUANTITY];
+		int loopStart;                       //Phase every channel is in its loop by...
+		int loopLength;                      //...and how many frames until they are all back where they were.
+
+		//State of the procedural animation while baking.
+		float jointAngles[10];
+		float jointSpeed[10];
+		float jointDirection[10];
+
+		void bake();
+		void findLoop(const vector<float> &bakedFrames, Channel &channel);
+		bool isRepeated(const vector<float> &bakedFrames, const Channel &channel, int start, int length);
+		void setup();
+		void step();
+		void runAnimation();
+		void runAnimationSetup();
+		void runArmAnimation(int lowerLimb, int upperLimb);
+		void runLegAnimation(int lowerLimb, int upperLimb);
+		void runNeckAnimation(int head, int neck);
+		void walkAnimation();
+		void walkAnimationSetup();
+		void walkArmAnimation(int lowerLimb, int upperLimb);
+		void walkLegAnimation(int lowerLimb, int upperLimb);
+		void walkNeckAnimation(int head, int neck);
+		void jumpAnimation();
+		void jumpAnimationSetup();
+		void jumpArmAnimation(int lowerLimb, int upperLimb);
+		void jumpLegAnimation(int lowerLimb, int upperLimb);
+		void jumpNeckAnimation(int head, int neck);
+	public:
+		static const int JOINT_QUANTITY = 10;
+
+		GaitTable(animation gaitParam);
+		static GaitTable* getTable(animation gait);
+		int advance(int phase);
+
+		//GETTERS
+		animation getGait();
+		void getJointAngles(int phase, float* jointAnglesParam);
+		int getLoopStart();
+		int getLoopLength();
+};
\ No newline at end of file
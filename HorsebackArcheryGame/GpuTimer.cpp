@@ -0,0 +1,58 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer(const char* nameParam)
+{
+	name = nameParam;
+	glGenQueries(RING_SIZE, queries);
+	for (int i = 0; i < RING_SIZE; i++) {
+		issueTimes[i] = 0.0;
+		isPending[i] = false;
+	}
+	current = 0;
+	times = new RollingStatistics(HISTORY);
+}
+
+//Start timing the commands issued from now on. Only one GL_TIME_ELAPSED query can be active at a time.
+void GpuTimer::begin()
+{
+	collect(current);
+	issueTimes[current] = Profiler::getInstance()->getTime();
+	glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::end()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	isPending[current] = true;
+	current = (current + 1) % RING_SIZE;
+}
+
+//Read back the result of a slot before it's reused. If the GPU is still more than RING_SIZE frames behind, the sample is
+//dropped instead of waiting for it.
+void GpuTimer::collect(int slot)
+{
+	if (!isPending[slot])
+		return;
+	isPending[slot] = false;
+
+	GLuint isAvailable = GL_FALSE;
+	glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+	if (!isAvailable)
+		return;
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+	times->addSample(nanoseconds / 1000000.0);
+	Profiler::getInstance()->addEvent(name, issueTimes[slot], nanoseconds / 1000.0, gpuTrack);
+}
+
+//GETTERS
+const char* GpuTimer::getName()
+{
+	return name;
+}
+
+RollingStatistics* GpuTimer::getTimes()
+{
+	return times;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "..\glew\glew.h"	//include GL Extension Wrangler
+#include "..\glfw\glfw3.h"	//include GLFW helper library
+
+#include "Profiler.h"
+
+//Measures how long the GPU spends on a render pass with GL_TIME_ELAPSED queries. The queries are kept in a ring and a
+//result is only read back when its slot comes around again, so reading it never stalls the CPU waiting on the GPU.
+class GpuTimer {
+	private:
+		static const int RING_SIZE = 4;  //Frames a query has to finish before its slot is reused.
+		static const int HISTORY = 600;  //Samples used for the percentiles.
+
+		const char* name;                //Has to be a string literal (see ProfileEvent).
+		GLuint queries[RING_SIZE];
+		double issueTimes[RING_SIZE];    //CPU time the pass was issued at (the trace places the GPU time there).
+		bool isPending[RING_SIZE];       //Whether the query was issued and its result not read yet.
+		int current;
+		RollingStatistics* times;        //Milliseconds.
+
+		void collect(int slot);
+	public:
+		GpuTimer(const char* nameParam);
+		void begin();
+		void end();
+
+		//GETTERS
+		const char* getName();
+		RollingStatistics* getTimes();
+};
\ No newline at end of file
@@ -1,25 +1,52 @@
+#include <math.h>           //For cos() and sin().
+#include <string.h>         //For memcmp().
 #include "Horse.h"
+#include "CounterRandom.h"
+
+const glm::vec4 Horse::WHITE = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+const glm::vec4 Horse::BLUE = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+const glm::vec4 Horse::YELLOW = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+const glm::vec4 Horse::FUCHSIA = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f);
+const glm::vec4 Horse::PURPLE = glm::vec4(0.25f, 0.0f, 0.75f, 1.0f);
+
+const float Horse::PI = 3.14f;
+const float Horse::MIN_SPEED = 0.25f;
+const float Horse::MAX_SPEED = 1.0f;
+const float Horse::CHANGE_ANIMATION_SPEED = 0.7f;
+const float Horse::DEGREES_TO_TURN = 30 * Horse::PI / 180;
+const float Horse::BOUNDING_RADIUS_FACTOR = 1.2f;
 
 //CONSTRUCTORS
 Horse::Horse() {
-	horse = NULL;
+	herd = NULL;
+	index = -1;
+	gaitTable = NULL;
+	gaitPhase = 0;
+	randomTick = 0;
+	randomDraws = 0;
 }
 
-Horse::Horse(GLuint objectColorLocationParam, GLuint transformLocationParam, GLuint VAOParam, int drawTypeParam, int idParam)
+Horse::Horse(HorseHerd* herdParam, int idParam)
 {
+	//Claim a slot in the herd first since most of the properties below live there.
+	herd = herdParam;
+	index = herd->addHorse();
+
 	//Set all properties that need to be determined during runtime.
-	objectColorLocation = objectColorLocationParam;
-	transformLocation = transformLocationParam;
-	VAO = VAOParam;
-	drawType = drawTypeParam;
 	id = idParam;
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f));
-	collisionQueue = new Queue();
+	randomTick = herd->tick;
+	randomDraws = 0;
 
-	pan = randomNumber(0, 72)*PI / 5;                    //Horse looks at random direction.
+	herd->pan[index] = randomNumber(0, 72)*PI / 5;                    //Horse looks at random direction.
 	scale = 0.8f + randomNumber(0, 22)*0.1f;             //Horse's size is varied by a reasonable range.
-	speed = randomNumber(5, 20)*0.05f;
+	herd->speed[index] = randomNumber(5, 20)*0.05f;
 	currentStopFrame = 0;
+	stopFrames = 0;
+	isStopped = false;
+	isSelected = false;
+	isControlled = false;
+	debugCollisionStatus = false;
+	tilt = 0.0f;
 	setStraightPathProperties();
 	if (randomNumber(0, 1) == 0)
 		direction = 1;
@@ -27,157 +54,84 @@ Horse::Horse(GLuint objectColorLocationParam, GLuint transformLocationParam, GLu
 		direction = -1;
 
 	scaleOffset = 1 + scale;
-	collisionRadius = 2.5f*(scaleOffset) / 2;
+	herd->collisionRadius[index] = 2.5f*(scaleOffset) / 2;
 
-	if (speed >= CHANGE_ANIMATION_SPEED)
+	if (herd->speed[index] >= CHANGE_ANIMATION_SPEED)
 		setAnimationType(run);
 	else
 		setAnimationType(walk);
 
 	randomizePosition();
+	herd->updateHeading(index);
 
 	color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
 	//Collision properties.
-	overallStatus = normal;
+	herd->overallStatus[index] = normal;
 	avoidingDirection = noDir;
+	directionAssigned = false;
 	radiansTurnedInCollision = 0.0f;
-	
-	//Create body parts.
-	horseTorso = new Node(color);
-	horseNeck = new Node(color);
-	horseHead = new Node(color);
-	horseLeftUpperArm = new Node(color);
-	horseRightUpperArm = new Node(color);
-	horseLeftUpperLeg = new Node(color);
-	horseRightUpperLeg = new Node(color);
-	horseLeftLowerArm = new Node(color);
-	horseRightLowerArm = new Node(color);
-	horseLeftLowerLeg = new Node(color);
-	horseRightLowerLeg = new Node(color);
-
-	horse = new Tree(horseTorso, objectColorLocation, transformLocation, VAO, drawType);
-
-	//Establish parent-child relationships between body parts of the horse.
-	horseTorso->addChild(horseNeck);
-	horseTorso->addChild(horseLeftUpperArm);
-	horseTorso->addChild(horseRightUpperArm);
-	horseTorso->addChild(horseLeftUpperLeg);
-	horseTorso->addChild(horseRightUpperLeg);
-	horseNeck->addChild(horseHead);
-	horseLeftUpperArm->addChild(horseLeftLowerArm);
-	horseRightUpperArm->addChild(horseRightLowerArm);
-	horseLeftUpperLeg->addChild(horseLeftLowerLeg);
-	horseRightUpperLeg->addChild(horseRightLowerLeg);
-
-	//Initialize stacks used for scaling, and the stack for both rotation and translation.
-	scaleMatrixStack = new Stack();
-	rotTransMatrixStack = new Stack();
+
+	//Built here the first time so the skeleton is never first touched by several threads at once.
+	getSkeleton();
 }
 
 //PRIVATE FUNCTIONS
-//Gets random integer from min to max
+//Gets random integer from min to max. Only depends on the seed, the horse's id, the tick and how many numbers the horse
+//drew earlier in the tick, so horses can be updated on any thread in any order.
 int Horse::randomNumber(int min, int max)
 {
-	return rand() % (max - min + 1) + min;
-}
-
-//Helps with rotation calculations where the center is different from the limb's center.
-glm::mat4 Horse::rotateOffset(float x, float y, float z) {
-	return glm::translate(modelMatrix, glm::vec3(x*scaleOffset, y*scaleOffset, z*scaleOffset));
+	if (randomTick != herd->tick) {
+		randomTick = herd->tick;
+		randomDraws = 0;
+	}
+	return CounterRandom::uniformInt(herd->randomSeed, id, herd->tick, randomDraws++, min, max);
 }
 
-void Horse::updateMatrices()
+//Body parts in the order of the bodyPart enum, each one after the body part it hangs off of. Lengths are in units of a
+//horse's scaleOffset. Each joint rotates around a point near the top of the body part (the pivot) and the limbs share
+//their shape.
+Tree Horse::buildSkeleton()
 {
-	horseTorsoScale = glm::scale(modelMatrix, glm::vec3(0.6f + scale*0.6, 0.2f + scale*0.2, 0.15f + scale*0.15));
-	horseNeckScale = glm::scale(horseTorsoScale, glm::vec3(0.5f, 0.7f, 0.75f));
-	horseHeadScale = glm::scale(horseNeckScale, glm::vec3(0.8f, 0.8f, 0.95f));
-	horseLimbScale = glm::scale(horseTorsoScale, glm::vec3(0.1428f, 1.5f, 0.33f));
-
-	horseTorsoRot = glm::translate(worldRotation, glm::vec3(0.0f + posX, 1.0f*scaleOffset, 0.0f + posZ))
-		*glm::rotate(modelMatrix, pan, glm::vec3(0.0f, 1.0f, 0.0f));
-	horseNeckRot = glm::translate(horseTorsoRot, glm::vec3(-0.75f*scaleOffset, 0.0f, 0.0f))
-		*rotateOffset(0.3f, 0.0f, 0.0f)
-		*glm::rotate(modelMatrix, -PI / 6 + jointAngles[1], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(-0.3f, 0.0f, 0.0f);
-	horseHeadRot = glm::translate(horseNeckRot, glm::vec3(-0.4f*scaleOffset, 0.0f*scaleOffset, 0.0f))
-		*rotateOffset(0.2f, 0.0f, 0.0f)
-		*glm::rotate(modelMatrix, PI / 2 + jointAngles[0], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(-0.2f, 0.0f, 0.0f);
-	horseLeftUpperArmRot = glm::translate(horseTorsoRot, glm::vec3(-0.45f*scaleOffset, -0.3f*scaleOffset, 0.1f*scaleOffset))
-		*rotateOffset(0.0f, 0.25f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[7], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.25f, 0.0f);
-	horseLeftLowerArmRot = glm::translate(horseLeftUpperArmRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
-		*rotateOffset(0.0f, 0.2f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[6], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.2f, 0.0f);
-	horseRightUpperArmRot = glm::translate(horseTorsoRot, glm::vec3(-0.45f*scaleOffset, -0.3f*scaleOffset, -0.1f*scaleOffset))
-		*rotateOffset(0.0f, 0.25f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[3], glm::vec3(0.0f, 0.0f, 1.0f))*rotateOffset(0.0f, -0.25f, 0.0f);
-	horseRightLowerArmRot = glm::translate(horseRightUpperArmRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
-		*rotateOffset(0.0f, 0.2f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[2], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.2f, 0.0f);
-	horseLeftUpperLegRot = glm::translate(horseTorsoRot, glm::vec3(0.45f*scaleOffset, -0.3f*scaleOffset, 0.1f*scaleOffset))
-		*rotateOffset(0.0f, 0.25f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[9], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.25f, 0.0f);
-	horseLeftLowerLegRot = glm::translate(horseLeftUpperLegRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
-		*rotateOffset(0.0f, 0.2f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[8], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.2f, 0.0f);
-	horseRightUpperLegRot = glm::translate(horseTorsoRot, glm::vec3(0.45f*scaleOffset, -0.3f*scaleOffset, -0.1f*scaleOffset))
-		*rotateOffset(0.0f, 0.25f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[5], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.25f, 0.0f);
-	horseRightLowerLegRot = glm::translate(horseRightUpperLegRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
-		*rotateOffset(0.0f, 0.2f, 0.0f)
-		*glm::rotate(modelMatrix, jointAngles[4], glm::vec3(0.0f, 0.0f, 1.0f))
-		*rotateOffset(0.0f, -0.2f, 0.0f);
-
-	horseTorso->setMatrices(horseTorsoScale, horseTorsoRot);
-	horseNeck->setMatrices(horseNeckScale, horseNeckRot);
-	horseHead->setMatrices(horseHeadScale, horseHeadRot);
-	horseLeftUpperArm->setMatrices(horseLimbScale, horseLeftUpperArmRot);
-	horseRightUpperArm->setMatrices(horseLimbScale, horseRightUpperArmRot);
-	horseLeftUpperLeg->setMatrices(horseLimbScale, horseLeftUpperLegRot);
-	horseRightUpperLeg->setMatrices(horseLimbScale, horseRightUpperLegRot);
-	horseLeftLowerArm->setMatrices(horseLimbScale, horseLeftLowerArmRot);
-	horseRightLowerArm->setMatrices(horseLimbScale, horseRightLowerArmRot);
-	horseLeftLowerLeg->setMatrices(horseLimbScale, horseLeftLowerLegRot);
-	horseRightLowerLeg->setMatrices(horseLimbScale, horseRightLowerLegRot);
-}
-
-void Horse::setColor(glm::vec4 &colorParam) {
+	glm::vec3 torsoShape(0.6f, 0.2f, 0.15f);
+	glm::vec3 neckShape = torsoShape*glm::vec3(0.5f, 0.7f, 0.75f);
+	glm::vec3 headShape = neckShape*glm::vec3(0.8f, 0.8f, 0.95f);
+	glm::vec3 limbShape = torsoShape*glm::vec3(0.1428f, 1.5f, 0.33f);
+	glm::vec3 noOffset(0.0f);
+
+	Tree skeleton;
+	skeleton.addNode(-1, -1, 0.0f, noOffset, noOffset, torsoShape);                                                      //Torso
+	skeleton.addNode(torsoPart, 1, -PI / 6, glm::vec3(-0.75f, 0.0f, 0.0f), glm::vec3(0.3f, 0.0f, 0.0f), neckShape);      //Neck
+	skeleton.addNode(neckPart, 0, PI / 2, glm::vec3(-0.4f, 0.0f, 0.0f), glm::vec3(0.2f, 0.0f, 0.0f), headShape);         //Head
+	skeleton.addNode(torsoPart, 7, 0.0f, glm::vec3(-0.45f, -0.3f, 0.1f), glm::vec3(0.0f, 0.25f, 0.0f), limbShape);       //Left upper arm
+	skeleton.addNode(leftUpperArmPart, 6, 0.0f, glm::vec3(0.0f, -0.4f, 0.0f), glm::vec3(0.0f, 0.2f, 0.0f), limbShape);   //Left lower arm
+	skeleton.addNode(torsoPart, 3, 0.0f, glm::vec3(-0.45f, -0.3f, -0.1f), glm::vec3(0.0f, 0.25f, 0.0f), limbShape);      //Right upper arm
+	skeleton.addNode(rightUpperArmPart, 2, 0.0f, glm::vec3(0.0f, -0.4f, 0.0f), glm::vec3(0.0f, 0.2f, 0.0f), limbShape);  //Right lower arm
+	skeleton.addNode(torsoPart, 9, 0.0f, glm::vec3(0.45f, -0.3f, 0.1f), glm::vec3(0.0f, 0.25f, 0.0f), limbShape);        //Left upper leg
+	skeleton.addNode(leftUpperLegPart, 8, 0.0f, glm::vec3(0.0f, -0.4f, 0.0f), glm::vec3(0.0f, 0.2f, 0.0f), limbShape);   //Left lower leg
+	skeleton.addNode(torsoPart, 5, 0.0f, glm::vec3(0.45f, -0.3f, -0.1f), glm::vec3(0.0f, 0.25f, 0.0f), limbShape);       //Right upper leg
+	skeleton.addNode(rightUpperLegPart, 4, 0.0f, glm::vec3(0.0f, -0.4f, 0.0f), glm::vec3(0.0f, 0.2f, 0.0f), limbShape);  //Right lower leg
+	return skeleton;
+}
+
+void Horse::setColor(const glm::vec4 &colorParam) {
 	color = colorParam;
-	horseTorso->setColor(color);
-	horseNeck->setColor(color);
-	horseHead->setColor(color);
-	horseLeftUpperArm->setColor(color);
-	horseRightUpperArm->setColor(color);
-	horseLeftUpperLeg->setColor(color);
-	horseRightUpperLeg->setColor(color);
-	horseLeftLowerArm->setColor(color);
-	horseRightLowerArm->setColor(color);
-	horseLeftLowerLeg->setColor(color);
-	horseRightLowerLeg->setColor(color);
 }
 
 
 //Change speed by a factor of up to 3 (i.e. up 3 times as much as the amount the speed increments).
 //Animations change when the speed passes the threshold in either direction.
 void Horse::randomSpeedChange() {
-	float initialSpeed = speed;
-	speed += randomNumber(-3, 3)*0.05f;
-	if (speed > MAX_SPEED)
-		speed = MAX_SPEED;
-	else if (speed < MIN_SPEED)
-		speed = MIN_SPEED;
-
-	if (speed >= CHANGE_ANIMATION_SPEED && initialSpeed < CHANGE_ANIMATION_SPEED)
+	float initialSpeed = herd->speed[index];
+	herd->speed[index] += randomNumber(-3, 3)*0.05f;
+	if (herd->speed[index] > MAX_SPEED)
+		herd->speed[index] = MAX_SPEED;
+	else if (herd->speed[index] < MIN_SPEED)
+		herd->speed[index] = MIN_SPEED;
+
+	if (herd->speed[index] >= CHANGE_ANIMATION_SPEED && initialSpeed < CHANGE_ANIMATION_SPEED)
 		setAnimationType(run);
-	else if (speed < CHANGE_ANIMATION_SPEED && initialSpeed >= CHANGE_ANIMATION_SPEED)
+	else if (herd->speed[index] < CHANGE_ANIMATION_SPEED && initialSpeed >= CHANGE_ANIMATION_SPEED)
 		setAnimationType(walk);
 }
 
@@ -186,7 +140,7 @@ bool Horse::progressFrame() {
 	if (currentStopFrame == stopFrames) {     //Stop period is over. Sets back the animation to walk or run depending on the horse speed.
 		currentStopFrame = 0;
 		isStopped = false;
-		if (speed >= CHANGE_ANIMATION_SPEED)
+		if (herd->speed[index] >= CHANGE_ANIMATION_SPEED)
 			setAnimationType(run);
 		else
 			setAnimationType(walk);
@@ -198,438 +152,110 @@ bool Horse::progressFrame() {
 
 //If a horse goes out of bounds next move, keep it near the edge.
 void Horse::checkBounds() {
-	if (posX < -50.0f)
-		posX = -50.0f;
-	else if (posX > 50.0f)
-		posX = 50.0f;
-	if (posZ < -50.0f)
-		posZ = -50.0f;
-	else if (posZ > 50.0f)
-		posZ = 50.0f;
+	if (herd->posX[index] < -50.0f)
+		herd->posX[index] = -50.0f;
+	else if (herd->posX[index] > 50.0f)
+		herd->posX[index] = 50.0f;
+	if (herd->posZ[index] < -50.0f)
+		herd->posZ[index] = -50.0f;
+	else if (herd->posZ[index] > 50.0f)
+		herd->posZ[index] = 50.0f;
 }
 
+//Move on to the next frame of the gait.
 void Horse::executeAnimation() {
-	if (animationType == walk)
-		walkAnimation();
-	else if (animationType == run)
-		runAnimation();
-	else
-		jumpAnimation();
+	gaitPhase = gaitTable->advance(gaitPhase);
 }
 
 animation Horse::getAnimationType() {
-	return animationType;
+	return gaitTable->getGait();
 }
 
-//Setup proper animation setup on animation change.
+//Start the gait from its first frame.
 void Horse::setAnimationType(animation animationTypeParam) {
-	if (animationTypeParam == walk)
-		walkAnimationSetup();
-	else if (animationTypeParam == run)
-		runAnimationSetup();
-	else
-		jumpAnimationSetup();
-	animationType = animationTypeParam;
+	gaitTable = GaitTable::getTable(animationTypeParam);
+	gaitPhase = 0;
 }
 
-//RUN ANIMATION
-//Execute run animation for all body parts.
-void Horse::runAnimation()
-{
-	runArmAnimation(2, 3);
-	runArmAnimation(6, 7);
-	runLegAnimation(4, 5);
-	runLegAnimation(8, 9);
-	runNeckAnimation(0, 1);
-}
+//PUBLIC FUNCTIONS
 
-//Initial joint properties before run animation starts.
-void Horse::runAnimationSetup()
+//FUNCTIONS RELATED TO DRAWING THE HORSE ITSELF
+//The skeleton every horse is drawn with. Horses only differ in size, pose and color, so they all share one.
+Tree* Horse::getSkeleton()
 {
-	for (int i = 0; i < 10; i++) {
-		jointAngles[i] = 0.0f;
-		jointSpeed[i] = 1.0f;
-		jointDirection[i] = 1.0f;
-	}
-
-	jointAngles[0] = -PI / 6;
-	jointAngles[1] = -PI / 8;
-	jointAngles[7] = -PI / 5;
-	jointAngles[5] = PI / 3;
-	jointAngles[9] = PI / 3 - PI / 5;
-	jointSpeed[4] = 2.5f;
-	jointSpeed[8] = 2.5f;
-	jointDirection[4] = -1.0f;
-	jointDirection[8] = -1.0f;
+	static Tree skeleton = buildSkeleton();
+	return &skeleton;
 }
 
-//Specific changes between angles, speed and direction to properly execute run animation for horse arms.
-void Horse::runArmAnimation(int lowerLimb, int upperLimb)
+//Write the world, model and normal matrix of every body part (in tree order) for the pose described by poseKey
+//(position, orientation, joint angles and world rotation, see getPoseKey()). The key doesn't have to be the horse's
+//current one (the renderer draws poses in between two simulation ticks). lastPoseKey is what the buffers were last
+//written for (NULL the first time): only the body parts the change of pose key moved are written, so the buffers have
+//to hold what the last call for this horse wrote. Gives back how many body parts were computed.
+int Horse::evaluatePose(const float* poseKey, const float* lastPoseKey, glm::mat4* worldMatrices, glm::mat4* modelMatrices,
+	NormalMatrix* normalMatrices)
 {
-	if (jointAngles[upperLimb] < -PI / 3) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-	if (jointAngles[upperLimb] > PI / 18) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-		jointAngles[lowerLimb] = PI / 2;
-		jointSpeed[lowerLimb] = 1.1f;
-	}
-
-	if (jointAngles[upperLimb] < -PI / 36) {
-		jointSpeed[upperLimb] = 1.0f;
-	}
-	else {
-		jointSpeed[upperLimb] = 0.5f;
-		if (jointDirection[lowerLimb] == 1.0f)
-			jointSpeed[lowerLimb] = 5.0f;
-	}
-
-	if (jointAngles[lowerLimb] > PI / 2) {
-		jointAngles[lowerLimb] = PI / 2;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
-}
-
-//Specific changes between angles, speed and direction to properly execute run animation for horse legs.
-void Horse::runLegAnimation(int lowerLimb, int upperLimb)
+	//The torso is placed by the position, pan and world rotation instead of a joint. Moving it and turning it around y
+	//only mixes the first and third column of the world rotation, so that is written out instead of multiplying matrices.
+	glm::mat4 torsoMatrix;
+	bool isTorsoChanged = lastPoseKey == NULL || memcmp(poseKey, lastPoseKey, 3 * sizeof(float)) != 0
+		|| memcmp(&poseKey[13], &lastPoseKey[13], 16 * sizeof(float)) != 0;
+	if (isTorsoChanged) {
+		glm::mat4 worldRotation = glm::make_mat4(&poseKey[13]);
+		float cosine = cos(poseKey[2]);
+		float sine = sin(poseKey[2]);
+		torsoMatrix[0] = worldRotation[0] * cosine - worldRotation[2] * sine;
+		torsoMatrix[1] = worldRotation[1];
+		torsoMatrix[2] = worldRotation[0] * sine + worldRotation[2] * cosine;
+		torsoMatrix[3] = worldRotation[0] * poseKey[0] + worldRotation[1] * scaleOffset + worldRotation[2] * poseKey[1] + worldRotation[3];
+	}
+
+	return getSkeleton()->evaluate(scaleOffset, torsoMatrix, isTorsoChanged, &poseKey[3], lastPoseKey == NULL ? NULL : &lastPoseKey[3],
+		worldMatrices, modelMatrices, normalMatrices);
+}
+
+//Sphere holding every body part in the pose of poseKey, centered on the torso (xyz is the center in world space, w the
+//radius). Used to skip drawing horses that can't be seen.
+glm::vec4 Horse::getBoundingSphere(const float* poseKey)
 {
-	if (jointAngles[upperLimb] > PI / 3) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-		jointSpeed[lowerLimb] = 2.5f;
-	}
-
-	if (jointAngles[upperLimb] < 0) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-		jointSpeed[lowerLimb] = 2.5f;
-	}
-
-	if (jointAngles[upperLimb] < PI / 18) {
-		jointSpeed[upperLimb] = 0.5f;
-	}
-	else
-		jointSpeed[upperLimb] = 1.0f;
-
-	if (jointAngles[lowerLimb] < -PI / 2) {
-		jointAngles[lowerLimb] = -PI / 2;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-	if (jointAngles[lowerLimb] > 0) {
-		jointAngles[lowerLimb] = 0;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+	glm::vec4 center = glm::make_mat4(&poseKey[13]) * glm::vec4(poseKey[0], 1.0f*scaleOffset, poseKey[1], 1.0f);
+	return glm::vec4(center.x, center.y, center.z, BOUNDING_RADIUS_FACTOR*herd->collisionRadius[index]);
 }
 
-//Specific changes between angles, speed and direction to properly execute run animation for horse's head and neck.
-void Horse::runNeckAnimation(int head, int neck)
+//Advance the animation of the horse. Only the horse's own joints change, so the whole herd can be animated at the same
+//time. Has to come before updateBehaviour() in the same frame.
+void Horse::animate()
 {
-	if (jointAngles[neck] > PI / 30)
-	{
-		jointDirection[neck] = -1.0f;
-		jointSpeed[neck] = 0.25f;
-		jointDirection[head] = -1.0f;
-		jointSpeed[head] = 0.25f;
-	}
-	if (jointAngles[neck] < -PI / 8)
-	{
-		jointDirection[neck] = 1.0f;
-		jointSpeed[neck] = 0.5f;
-		jointDirection[head] = 1.0f;
-		jointSpeed[head] = 0.5f;
-	}
-	if (jointAngles[head] > 0.0f) {
-		jointAngles[head] = 0.0f;
-	}
-	if (jointAngles[head] < -PI / 6) {
-		jointAngles[head] = -PI / 6;
-	}
-	jointAngles[neck] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
-	jointAngles[head] += ((RUN_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
-}
-
-//WALK ANIMATION
-//Execute walk animation for all body parts.
-void Horse::walkAnimation() {
-	walkArmAnimation(2, 3);
-	walkArmAnimation(6, 7);
-	walkLegAnimation(4, 5);
-	walkLegAnimation(8, 9);
-	walkNeckAnimation(0, 1);
-}
-
-//Initial joint properties before walk animation starts.
-void Horse::walkAnimationSetup() {
-	for (int i = 0; i < 10; i++) {
-		jointAngles[i] = 0.0f;
-		jointSpeed[i] = 1.0f;
-		jointDirection[i] = 1.0f;
-	}
-
-	jointAngles[2] = PI / 36;
-	jointDirection[2] = -1.0f;
-	jointDirection[3] = 1.0f;
-	jointSpeed[3] = 3.0f;
-	jointAngles[6] = -PI / 6;
-	jointDirection[6] = 1.0f;
-	jointDirection[7] = -1.0f;
-	jointSpeed[7] = 1.5f;
-	jointAngles[4] = -PI / 36;
-	jointDirection[4] = 1.0f;
-	jointDirection[5] = -1.0f;
-	jointSpeed[5] = 1.5f;
-	jointAngles[8] = PI / 6;
-	jointDirection[8] = -1.0f;
-	jointDirection[9] = 1.0f;
-	jointSpeed[9] = 3.0f;
-}
-
-//Specific changes between angles, speed and direction to properly execute walk animation for horse arms.
-void Horse::walkArmAnimation(int lowerLimb, int upperLimb) {
-	if (jointAngles[upperLimb] < -PI / 6) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-		jointSpeed[lowerLimb] = 1.5f;
-	}
-	if (jointAngles[upperLimb] > PI / 36) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-		jointSpeed[lowerLimb] = 3.0f;
-	}
-
-	if (jointAngles[upperLimb] < 0)
-		jointSpeed[upperLimb] = 1.0f;
-	else
-		jointSpeed[upperLimb] = 0.2f;
-
-	if (jointAngles[lowerLimb] > PI / 4) {
-		jointAngles[lowerLimb] = PI / 4;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-	if (jointAngles[lowerLimb] < 0) {
-		jointAngles[lowerLimb] = 0.0f;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
-}
-
-//Specific changes between angles, speed and direction to properly execute walk animation for horse legs.
-void Horse::walkLegAnimation(int lowerLimb, int upperLimb) {
-	if (jointAngles[upperLimb] < -PI / 36) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-		jointSpeed[lowerLimb] = 1.5f;
-	}
-	if (jointAngles[upperLimb] > PI / 6) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-		jointSpeed[lowerLimb] = 3.0f;
-	}
-
-	if (jointAngles[upperLimb] > 0)
-		jointSpeed[upperLimb] = 1.0f;
-	else
-		jointSpeed[upperLimb] = 0.2f;
-
-	if (jointAngles[lowerLimb] > PI / 4) {
-		jointAngles[lowerLimb] = PI / 4;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-	if (jointAngles[lowerLimb] < 0) {
-		jointAngles[lowerLimb] = 0.0f;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
-}
-
-//Specific changes between angles, speed and direction to properly execute walk animation for horse's head and neck.
-void Horse::walkNeckAnimation(int head, int neck) {
-	if (jointAngles[neck] > PI / 45)
-	{
-		jointDirection[neck] = -1.0f;
-		jointSpeed[neck] = 0.25f;
-		jointDirection[head] = -1.0f;
-		jointSpeed[head] = 0.25f;
-	}
-	if (jointAngles[neck] < -PI / 30)
-	{
-		jointDirection[neck] = 1.0f;
-		jointSpeed[neck] = 0.5f;
-		jointDirection[head] = 1.0f;
-		jointSpeed[head] = 0.5f;
-	}
-	if (jointAngles[head] > 0.0f) {
-		jointAngles[head] = 0.0f;
-	}
-	if (jointAngles[head] < -PI / 6) {
-		jointAngles[head] = -PI / 6;
-	}
-	jointAngles[neck] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
-	jointAngles[head] += ((WALK_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
-}
-
-//JUMP ANIMATION
-//Execute jump animation for all body parts.
-void Horse::jumpAnimation() {
-	jumpArmAnimation(2, 3);
-	jumpArmAnimation(6, 7);
-	jumpLegAnimation(4, 5);
-	jumpLegAnimation(8, 9);
-	jumpNeckAnimation(0, 1);
-}
-
-//Initial joint properties before jump animation starts.
-void Horse::jumpAnimationSetup() {
-	for (int i = 0; i < 10; i++) {
-		jointAngles[i] = 0.0f;
-		jointSpeed[i] = 1.0f;
-		jointDirection[i] = 1.0f;
-	}
-
-	jointSpeed[5] = 0.0f;
-	jointDirection[5] = -1.0f;
-	jointSpeed[9] = 0.0f;
-	jointDirection[9] = -1.0f;
-}
-
-//Specific changes between angles, speed and direction to properly execute jump animation for horse arms.
-void Horse::jumpArmAnimation(int lowerLimb, int upperLimb) {
-	if (jointAngles[upperLimb] < -PI / 3) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-	}
-	if (jointAngles[upperLimb] > 0) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-		jointSpeed[lowerLimb] = 2.0f;
-	}
-
-	if (jointAngles[upperLimb] > -PI / 4) {
-		jointSpeed[upperLimb] = 1.5f;
-		if (jointDirection[lowerLimb] == -1.0f && jointAngles[lowerLimb] > 0.0f)
-			jointSpeed[lowerLimb] = 5.0f;
-	}
-	else
-		jointSpeed[upperLimb] = 0.2f;
-
-	if (jointAngles[lowerLimb] > 5* PI / 8) {
-		jointAngles[lowerLimb] = 5 * PI / 8;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-	if (jointAngles[lowerLimb] < 0) {
-		jointAngles[lowerLimb] = 0.0f;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
+	//Always execute animation when movement occurs (controlled horse moves using different functions).
+	if ((getCollisionStatus() != stopped && getCollisionStatus() != controlled) && !isStopped)
+		executeAnimation();
+	else if (isStopped && currentStopFrame <= JUMP_FRAMES) //Do animation for horse only once!
+		executeAnimation();
 }
 
-//Specific changes between angles, speed and direction to properly execute jump animation for horse legs.
-void Horse::jumpLegAnimation(int lowerLimb, int upperLimb) {
-	if (jointAngles[upperLimb] < 0) {
-		jointDirection[upperLimb] = 1.0f;
-		jointDirection[lowerLimb] = 1.0f;
-	}
-	if (jointAngles[upperLimb] > PI / 3) {
-		jointDirection[upperLimb] = -1.0f;
-		jointDirection[lowerLimb] = -1.0f;
-		jointSpeed[lowerLimb] = 2.5f;
-	}
-
-	if (jointAngles[upperLimb] < PI / 4) {
-		jointSpeed[upperLimb] = 1.5f;
-		if (jointDirection[upperLimb] == 1.0f)
-			jointSpeed[lowerLimb] = 0.0f;
-	}
-	else
-		jointSpeed[upperLimb] = 0.2f;
-
-	if (jointAngles[lowerLimb] < -5 * PI / 8) {
-		jointAngles[lowerLimb] = -5 * PI / 8;
-		jointDirection[lowerLimb] = 1.0f;
-	}
-	if (jointAngles[lowerLimb] > 0) {
-		jointAngles[lowerLimb] = 0.0f;
-		jointSpeed[lowerLimb] = 0.0f;
-	}
-
-	jointAngles[upperLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[upperLimb] * jointDirection[upperLimb]);
-	jointAngles[lowerLimb] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[lowerLimb] * jointDirection[lowerLimb]);
-}
-
-//Specific changes between angles, speed and direction to properly execute jump animation for horse's head and neck.
-void Horse::jumpNeckAnimation(int head, int neck) {
-	if (jointAngles[neck] > PI / 15)
-	{
-		jointDirection[neck] = -1.0f;
-		jointSpeed[neck] = 0.125f;
-		jointDirection[head] = -1.0f;
-		jointSpeed[head] = 0.125f;
-	}
-	if (jointAngles[neck] < -PI / 40)
-	{
-		jointDirection[neck] = 1.0f;
-		jointSpeed[neck] = 0.25f;
-		jointDirection[head] = 1.0f;
-		jointSpeed[head] = 0.25f;
-	}
-	if (jointAngles[head] > 0.0f) {
-		jointAngles[head] = 0.0f;
-	}
-	if (jointAngles[head] < -PI / 6) {
-		jointAngles[head] = -PI / 6;
-	}
-	jointAngles[neck] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[neck] * jointDirection[neck]);
-	jointAngles[head] += ((JUMP_SPEED_MULTIPLIER*PI / 180.0f)*jointSpeed[head] * jointDirection[head]);
-}
-
-//PUBLIC FUNCTIONS
-
-//FUNCTIONS RELATED TO DRAWING THE HORSE ITSELF
-void Horse::draw() {
-	horse->drawTraversalFromRoot(scaleMatrixStack, rotTransMatrixStack);
-	updateMatrices();
-}
-
-void Horse::updatePosition() 
+//Move, turn, change speed or stop. Only the horse's own properties change, so the whole herd can be updated at the same
+//time. Has to come after animate() in the same frame.
+void Horse::updateBehaviour()
 {
 	//All scenarios when horse moves (controlled horse moves using different functions)
 	if ((getCollisionStatus() != stopped && getCollisionStatus() != controlled) && !isStopped) {
-		executeAnimation(); //Always execute animation when movement occurs.
-
 		//Go straight if it doesn't collide with any other horse.
 		if (avoidingDirection == straightDir || (avoidingDirection == noDir && getCollisionStatus() != avoiding)) {
 			if (currentSteps == stepToChangeSpeedAt && doWeChangeSpeed) //Change speed at proper step if applicable.
 				randomSpeedChange();
 			if (currentSteps == stepToChangeSpeedAt && doWeStop)        //Stop at proper step if applicable.
 				stopHorse();
-			if ((currentSteps < steps || getCollisionStatus() != normal) && (posX >= -50.0f && posX <= 50.0f) && (posZ >= -50.0f && posZ <= 50.0f)) {
+			if ((currentSteps < steps || getCollisionStatus() != normal) && (herd->posX[index] >= -50.0f && herd->posX[index] <= 50.0f) && (herd->posZ[index] >= -50.0f && herd->posZ[index] <= 50.0f)) {
 				radiansTurnedInCollision = 0.0f;
 				if (getCollisionStatus() == normal)
 					currentSteps++;
-				posX += speed*cos(pan + PI);
-				posZ += speed*-sin(pan + PI);
-				checkBounds();
+				herd->isMoving[index] = -1;      //The whole herd moves at once after every horse is updated (see HorseHerd::integrate()).
 			}
 			else
 			{
 				checkBounds();
 				setStraightPathProperties();
-				pan += DEGREES_TO_TURN * direction;
+				herd->pan[index] += DEGREES_TO_TURN * direction;
 				if (randomNumber(0, 1) == 0)
 					direction = 1;
 				else
@@ -638,41 +264,59 @@ void Horse::updatePosition()
 		}
 		//Turn left
 		else if (avoidingDirection == leftDir) {
-			pan += DEGREES_TO_TURN;
+			herd->pan[index] += DEGREES_TO_TURN;
 			radiansTurnedInCollision += DEGREES_TO_TURN;
 		}
 		//Turn right
 		else {
-			pan -= DEGREES_TO_TURN;
+			herd->pan[index] -= DEGREES_TO_TURN;
 			radiansTurnedInCollision += DEGREES_TO_TURN;
 		}
 	}
 
 	//If horse is selected to randomly stop, progress frames until horse can move again.
-	else if (isStopped) {
-		if (currentStopFrame <= JUMP_FRAMES) //Do animation for horse only once!
-			executeAnimation();
+	else if (isStopped)
 		progressFrame();
-	}
 }
 
 //GETTERS
 glm::vec3 Horse::getPosition() {
-	return glm::vec3(posX, posY, posZ);
+	return glm::vec3(herd->posX[index], posY, herd->posZ[index]);
 }
 
 float Horse::getCollisionRadius() {
-	return collisionRadius;
+	return herd->collisionRadius[index];
 }
 
 status Horse::getCollisionStatus() {
-	return overallStatus;
+	return herd->overallStatus[index];
 }
 
 int Horse::getId() {
 	return id;
 }
 
+//Lengths of the horse's body parts are in units of this (see buildSkeleton()).
+float Horse::getScaleOffset() {
+	return scaleOffset;
+}
+
+//Color every body part of the horse is drawn with.
+glm::vec4 Horse::getColor() {
+	return color;
+}
+
+//The values the pose is computed from. If they are the same as last frame, so is the pose. The first MOTION_KEY_SIZE
+//values (position, pan and joint angles) change as the horse moves, the rest is the world rotation.
+void Horse::getPoseKey(float* poseKey) {
+	poseKey[0] = herd->posX[index];
+	poseKey[1] = herd->posZ[index];
+	poseKey[2] = herd->pan[index];
+	gaitTable->getJointAngles(gaitPhase, &poseKey[3]);
+	for (int i = 0; i < 16; i++)
+		poseKey[13 + i] = herd->worldRotation[i];
+}
+
 forecastDirection Horse::getAvoidingDirection() {
 	return avoidingDirection;
 }
@@ -688,18 +332,24 @@ bool Horse::getIsHorseStopped() {
 //Predict where horse is going to be when going straight.
 glm::vec3 Horse::getForecastedPosition(forecastDirection direction) {
 	if (direction == straightDir) {
-		float forecastedPosX = posX + speed*cos(pan + PI);
-		float forecastedPosZ = posZ + speed*-sin(pan + PI);
+		float forecastedPosX, forecastedPosZ;
+		herd->getForecastedPosition(index, forecastedPosX, forecastedPosZ);
 		return glm::vec3(forecastedPosX, posY, forecastedPosZ);
 	}
 	else
-		return glm::vec3(posX, posY, posZ);
+		return glm::vec3(herd->posX[index], posY, herd->posZ[index]);
 }
 
 //SETTERS
+//Move the horse to a spot on the field (height stays the same).
+void Horse::setPosition(float x, float z) {
+	herd->posX[index] = x;
+	herd->posZ[index] = z;
+}
+
 void Horse::setCollisionStatus(status statusParam) {
 	if (statusParam == controlled || !isControlled)
-		overallStatus = statusParam;
+		herd->overallStatus[index] = statusParam;
 	if (debugCollisionStatus && !isControlled && !isSelected) {
 		if (statusParam == normal)
 			setColor(WHITE);
@@ -710,16 +360,6 @@ void Horse::setCollisionStatus(status statusParam) {
 	}
 }
 
-
-void Horse::setWorldRotation(glm::mat4 &worldRotationParam) {
-	worldRotation = worldRotationParam;
-}
-
-void Horse::setDrawType(int drawTypeParam) {
-	drawType = drawTypeParam;
-	horse->setDrawType(drawTypeParam);
-}
-
 void Horse::setAvoidingDirection(forecastDirection direction){
 	avoidingDirection = direction;
 }
@@ -753,9 +393,9 @@ void Horse::setDebugCollisionStatus(bool statusParam)
 
 //FUNCTIONS RELATED TO OTHER HORSE PROPERTIES.
 void Horse::randomizePosition() {
-	posX = (float)randomNumber(-50, 50);
+	herd->posX[index] = randomNumber(-5000, 5000) / 100.0f;
 	posY = 1.0f*scaleOffset;
-	posZ = (float)randomNumber(-50, 50);
+	herd->posZ[index] = randomNumber(-5000, 5000) / 100.0f;
 }
 
 //Resets properties that are only relevant when a horse goes a straight path.
@@ -769,21 +409,17 @@ void Horse::setStraightPathProperties()
 	doWeStop = randomNumber(0, 9) < 2 ? true : false;
 }
 
-bool Horse::doCollisionsExist() {
-	if (collisionQueue->getSize() > 0)
-		return true;
-	else
-		return false;
-}
-
 //Horse is trapped if turned 360 degrees cumulatively (i.e. not necessarily 360 degrees left or right entirely)
 bool Horse::isTrapped() {
-	if (radiansTurnedInCollision >= 2 * PI) {
-		radiansTurnedInCollision = 0.0f;
-		return true;
-	}
-	else
-		return false;
+	return radiansTurnedInCollision >= 2 * PI;
+}
+
+//A trapped horse stops and forgets where it was avoiding to, and starts counting its turns again.
+void Horse::releaseFromTrap() {
+	radiansTurnedInCollision = 0.0f;
+	setCollisionStatus(stopped);
+	directionAssigned = false;
+	avoidingDirection = noDir;
 }
 
 //Horse jumps once when stopped.
@@ -797,60 +433,39 @@ void Horse::stopHorse() {
 	isStopped = true;
 }
 
-void Horse::addCollision(int id) {
-	collisionQueue->enqueue(id);
-}
-
-void Horse::removeCollision(int id) {
-	collisionQueue->removeElement(id);
-}
-
-int Horse::getCurrentCollision() {
-	return collisionQueue->getFront();
-}
-
-//Check if a horse is in the list of collisions.
-bool Horse::collisionTargetPresent(int id) {
-	bool identified = false;
-	for (int i = 0; i < collisionQueue->getSize(); i++) {
-		if (collisionQueue->getElement(i) == id) {
-			identified = true;
-			break;
-		}
-	}
-	return identified;
-}
-
 //Movement function for controlled horse.
 void Horse::move(forecastDirection direction) {
 	if (!isStopped) {
 		if (direction == straightDir) {
-			posX += speed*cos(pan + PI);
-			posZ += speed*-sin(pan + PI);
+			herd->posX[index] += herd->speed[index]*herd->headingX[index];
+			herd->posZ[index] += herd->speed[index]*herd->headingZ[index];
 			checkBounds();
 			executeAnimation(); //Controlled horse only animates when moving (only jumps when randomly selected to stop).
 		}
 		else if (direction == leftDir)
-			pan += DEGREES_TO_TURN;
+			herd->pan[index] += DEGREES_TO_TURN;
 		else if (direction == rightDir)
-			pan -= DEGREES_TO_TURN;
+			herd->pan[index] -= DEGREES_TO_TURN;
+		herd->updateHeading(index);      //Controlled horses move between frames so they can't wait for the next herd-wide update.
 	}
 }
 
 void Horse::incrementSpeed() {
-	speed += 0.05f;
-	if (speed > MAX_SPEED)
-		speed = MAX_SPEED;
-	if (speed >= CHANGE_ANIMATION_SPEED)
+	herd->speed[index] += 0.05f;
+	if (herd->speed[index] > MAX_SPEED)
+		herd->speed[index] = MAX_SPEED;
+	if (herd->speed[index] >= CHANGE_ANIMATION_SPEED)
 		setAnimationType(run);
+	herd->updateHeading(index);      //The forecast depends on the speed (see move()).
 }
 
 void Horse::decrementSpeed() {
-	speed -= 0.05f;
-	if (speed < MIN_SPEED)
-		speed = MIN_SPEED;
-	if (speed < CHANGE_ANIMATION_SPEED)
+	herd->speed[index] -= 0.05f;
+	if (herd->speed[index] < MIN_SPEED)
+		herd->speed[index] = MIN_SPEED;
+	if (herd->speed[index] < CHANGE_ANIMATION_SPEED)
 		setAnimationType(walk);
+	herd->updateHeading(index);      //The forecast depends on the speed (see move()).
 }
 
 //If horse isn't controlled or selected, 
@@ -870,10 +485,4 @@ void Horse::updateDebugColors() {
 		else
 			setColor(WHITE);
 	}
-}
-
-//Allows new instances of node to have the proper byte boundaries (they change since glm::mat4 parameters are passed)!
-void* Horse::operator new(size_t i)
-{
-	return _mm_malloc(i, 16);
 }
\ No newline at end of file
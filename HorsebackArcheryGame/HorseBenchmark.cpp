@@ -0,0 +1,626 @@
+/***************************************************************************************************\
+| Program:     Horse Benchmark                                                                      |
+| Description: Micro benchmarks for the simulation data layouts. Runs the per-frame movement and    |
+|              collision work over a herd stored the old way (one big object per horse, reached     |
+|              through a pointer) and over the HorseHerd arrays, then reports time per frame, how   |
+|              far the horse data is spread in memory and cache misses (Linux only, read from the   |
+|              hardware counters when they are available).                                          |
+|              Also times the heading kernel, the body part matrix kernel and composing matrices on |
+|              the matrix backend (glm SSE types, or plain glm with HORSE_NO_SIMD), and checks them |
+|              against the straightforward versions they replaced.                                  |
+| Usage:       HorseBenchmark [--horses N] [--frames F]                                             |
+|              - N: only run this herd size (default runs 1000, 10000 and 100000).                  |
+|              - F: amount of frames to run (default scales with the herd size).                    |
+| Building:    Part of the Visual Studio solution. On other platforms compile this file together    |
+|              with the sources listed in HorseSimulation.vcxproj and put ../glm and .. on the      |
+|              include path, e.g. on Linux:                                                         |
+|              g++ -O2 -std=c++11 -pthread -I../glm -I.. HorseBenchmark.cpp <sources>               |
+\***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>        //For min() and max().
+#include <chrono>           //For timing the benchmarks.
+#include <string>
+#include <xmmintrin.h>      //For _mm_malloc().
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "glm.hpp"
+#include "HorseHerd.h"
+#include "SpatialGrid.h"
+#include "Horse.h"
+#include "SimdMatrix.h"
+
+using namespace std;
+
+const float PI = 3.14f;
+const float TURN_PER_FRAME = 0.01f;
+const float JOINT_TOLERANCE = 0.00001f;       //Largest difference allowed between the two ways of building body part matrices.
+const int CHAIN_LENGTH = 5;                   //Matrices per product in the matrix backend benchmark (as many as the camera's view matrix).
+const int CHAIN_MATRIX_QUANTITY = 1024;       //Different matrices the chains are made of.
+const int HORSES_PER_DEFAULT_FIELD = 1000;     //Field grows with the herd so the amount of collisions per horse stays about the same.
+const float DEFAULT_FIELD_HALF_SIZE = 50.0f;
+
+//The per-frame fields of a horse laid out the way Horse used to keep them: between colors, matrices, body part pointers
+//and animation state. Only the layout matters here, the cold members are never read.
+struct LegacyHorse {
+	glm::vec4 colors[5];
+	glm::mat4 modelMatrix;
+	glm::mat4 worldRotation;
+	bool flags[4];
+	int id;
+	float posX;
+	float posY;
+	float posZ;
+	float pan;
+	float tilt;
+	float speed;
+	int animationType;
+	glm::vec4 color;
+	int stepProperties[9];
+	int avoidingDirection;
+	bool directionAssigned;
+	float radiansTurnedInCollision;
+	float collisionRadius;
+	status overallStatus;
+	float jointAngles[10];
+	float jointSpeed[10];
+	float jointDirection[10];
+	float scale;
+	float scaleOffset;
+	void* bodyParts[12];
+	glm::mat4 scaleMatrices[4];
+	glm::mat4 rotTransMatrices[11];
+};
+
+//A body part the way they used to be allocated, one by one next to their horse.
+struct LegacyBodyPart {
+	glm::vec4 color;
+	glm::mat4 matrices[3];
+	vector<LegacyBodyPart*> children;
+};
+
+//Counts last level cache misses of this process while running. Reports nothing when the counters can't be opened (not
+//Linux, no permission or running in a virtual machine without them).
+class CacheMissCounter {
+	private:
+		int fileDescriptor;
+	public:
+		CacheMissCounter()
+		{
+			fileDescriptor = -1;
+#ifdef __linux__
+			struct perf_event_attr attributes;
+			memset(&attributes, 0, sizeof(attributes));
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.size = sizeof(attributes);
+			attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+			attributes.disabled = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			fileDescriptor = (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+		}
+		bool isAvailable()
+		{
+			return fileDescriptor != -1;
+		}
+		void start()
+		{
+#ifdef __linux__
+			if (isAvailable()) {
+				ioctl(fileDescriptor, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fileDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+		long long stop()
+		{
+			long long count = 0;
+#ifdef __linux__
+			if (isAvailable()) {
+				ioctl(fileDescriptor, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(fileDescriptor, &count, sizeof(count)) != sizeof(count))
+					count = 0;
+			}
+#endif
+			return count;
+		}
+};
+
+struct BenchmarkResult {
+	double millisecondsPerFrame;
+	long long cacheMisses;
+	double checksum;
+};
+
+int randomNumber(int min, int max)
+{
+	return rand() % (max - min + 1) + min;
+}
+
+//One frame of the old layout: forecast every horse, test the candidate pairs and move the horses that are free to go.
+void legacyFrame(vector<LegacyHorse*> &horses, vector<pair<int, int> > &pairs, float fieldHalfSize, vector<float> &forecastsX, vector<float> &forecastsZ)
+{
+	for (int i = 0; i < horses.size(); i++) {
+		forecastsX[i] = horses[i]->posX + horses[i]->speed*cos(horses[i]->pan + PI);
+		forecastsZ[i] = horses[i]->posZ + horses[i]->speed*-sin(horses[i]->pan + PI);
+		horses[i]->overallStatus = normal;
+	}
+	for (int i = 0; i < pairs.size(); i++) {
+		LegacyHorse* horse1 = horses[pairs[i].first];
+		LegacyHorse* horse2 = horses[pairs[i].second];
+		float distanceX = forecastsX[pairs[i].second] - forecastsX[pairs[i].first];
+		float distanceZ = forecastsZ[pairs[i].second] - forecastsZ[pairs[i].first];
+		if (sqrt(distanceX*distanceX + distanceZ*distanceZ) <= horse1->collisionRadius + horse2->collisionRadius) {
+			horse1->overallStatus = avoiding;
+			horse2->overallStatus = stopped;
+		}
+	}
+	for (int i = 0; i < horses.size(); i++) {
+		LegacyHorse* horse = horses[i];
+		if (horse->overallStatus != stopped) {
+			horse->posX = fmin(fmax(forecastsX[i], -fieldHalfSize), fieldHalfSize);
+			horse->posZ = fmin(fmax(forecastsZ[i], -fieldHalfSize), fieldHalfSize);
+		}
+		horse->pan += horse->overallStatus == avoiding ? -TURN_PER_FRAME : TURN_PER_FRAME;
+	}
+}
+
+//The same frame over the herd arrays.
+void herdFrame(HorseHerd &herd, vector<pair<int, int> > &pairs, float fieldHalfSize, vector<float> &forecastsX, vector<float> &forecastsZ)
+{
+	int quantity = herd.getQuantity();
+	for (int i = 0; i < quantity; i++) {
+		forecastsX[i] = herd.posX[i] + herd.speed[i]*cos(herd.pan[i] + PI);
+		forecastsZ[i] = herd.posZ[i] + herd.speed[i]*-sin(herd.pan[i] + PI);
+		herd.overallStatus[i] = normal;
+	}
+	for (int i = 0; i < pairs.size(); i++) {
+		int horse1 = pairs[i].first;
+		int horse2 = pairs[i].second;
+		float distanceX = forecastsX[horse2] - forecastsX[horse1];
+		float distanceZ = forecastsZ[horse2] - forecastsZ[horse1];
+		if (sqrt(distanceX*distanceX + distanceZ*distanceZ) <= herd.collisionRadius[horse1] + herd.collisionRadius[horse2]) {
+			herd.overallStatus[horse1] = avoiding;
+			herd.overallStatus[horse2] = stopped;
+		}
+	}
+	for (int i = 0; i < quantity; i++) {
+		if (herd.overallStatus[i] != stopped) {
+			herd.posX[i] = fmin(fmax(forecastsX[i], -fieldHalfSize), fieldHalfSize);
+			herd.posZ[i] = fmin(fmax(forecastsZ[i], -fieldHalfSize), fieldHalfSize);
+		}
+		herd.pan[i] += herd.overallStatus[i] == avoiding ? -TURN_PER_FRAME : TURN_PER_FRAME;
+	}
+}
+
+//Compares the two layouts on the same herd (same starting state, same candidate pairs) and prints the results. Returns
+//false if the two layouts didn't end up in the same state.
+bool runLayoutBenchmark(int horseQuantity, int frames)
+{
+	float fieldHalfSize = DEFAULT_FIELD_HALF_SIZE*(float)sqrt((double)horseQuantity / HORSES_PER_DEFAULT_FIELD);
+
+	//Generate both herds with the same properties. Body parts are allocated in between the old horses like the old
+	//constructor did, so they end up as spread out in memory as they used to be.
+	srand(1);
+	HorseHerd herd;
+	vector<LegacyHorse*> legacyHorses;
+	vector<LegacyBodyPart*> bodyParts;
+	for (int i = 0; i < horseQuantity; i++) {
+		LegacyHorse* legacyHorse = (LegacyHorse*)_mm_malloc(sizeof(LegacyHorse), 16);
+		for (int j = 0; j < 11; j++)
+			bodyParts.push_back(new LegacyBodyPart());
+		int index = herd.addHorse();
+		float scale = 0.8f + randomNumber(0, 22)*0.1f;
+		legacyHorse->pan = herd.pan[index] = randomNumber(0, 72)*PI / 5;
+		legacyHorse->speed = herd.speed[index] = randomNumber(5, 20)*0.05f;
+		legacyHorse->collisionRadius = herd.collisionRadius[index] = 2.5f*(1 + scale) / 2;
+		legacyHorse->posX = herd.posX[index] = (randomNumber(0, 10000) / 5000.0f - 1.0f)*fieldHalfSize;
+		legacyHorse->posZ = herd.posZ[index] = (randomNumber(0, 10000) / 5000.0f - 1.0f)*fieldHalfSize;
+		legacyHorse->overallStatus = herd.overallStatus[index] = normal;
+		legacyHorses.push_back(legacyHorse);
+	}
+
+	//Candidate pairs are found once so both layouts do exactly the same collision work every frame.
+	vector<float> forecastsX(horseQuantity);
+	vector<float> forecastsZ(horseQuantity);
+	vector<pair<int, int> > pairs;
+	SpatialGrid grid(fieldHalfSize);
+	grid.rebuild(herd.posX, herd.posZ, horseQuantity, 2 * herd.getLargestCollisionRadius());
+	grid.findCandidatePairs(pairs);
+
+	BenchmarkResult results[2];
+	CacheMissCounter counter;
+	for (int layout = 0; layout < 2; layout++) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		counter.start();
+		for (int i = 0; i < frames; i++) {
+			if (layout == 0)
+				legacyFrame(legacyHorses, pairs, fieldHalfSize, forecastsX, forecastsZ);
+			else
+				herdFrame(herd, pairs, fieldHalfSize, forecastsX, forecastsZ);
+		}
+		results[layout].cacheMisses = counter.stop();
+		chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+		results[layout].millisecondsPerFrame = chrono::duration<double>(end - start).count() * 1000.0 / frames;
+
+		//Both layouts run the exact same operations so they have to finish in the exact same state.
+		results[layout].checksum = 0.0;
+		for (int i = 0; i < horseQuantity; i++) {
+			if (layout == 0)
+				results[layout].checksum += legacyHorses[i]->posX + legacyHorses[i]->posZ * 3 + legacyHorses[i]->overallStatus;
+			else
+				results[layout].checksum += herd.posX[i] + herd.posZ[i] * 3 + herd.overallStatus[i];
+		}
+	}
+
+	//Without cache miss counters how far the horse data is spread is what tells whether the herd still fits in the cache:
+	//the old horses sit between their body parts, the arrays only hold the fields the frame reads.
+	char* lowestHorse = (char*)legacyHorses[0];
+	char* highestHorse = (char*)legacyHorses[0];
+	for (int i = 1; i < horseQuantity; i++) {
+		lowestHorse = min(lowestHorse, (char*)legacyHorses[i]);
+		highestHorse = max(highestHorse, (char*)legacyHorses[i]);
+	}
+	double legacyMegabytes = (highestHorse - lowestHorse + sizeof(LegacyHorse)) / (1024.0*1024.0);
+	double herdMegabytes = horseQuantity*(5 * sizeof(float) + sizeof(status)) / (1024.0*1024.0);
+
+	printf("%7d horses, %5d frames, %8d candidate pairs\n", horseQuantity, frames, (int)pairs.size());
+	printf("  horse data spread over: %.2f MB (object per horse), %.2f MB (HorseHerd arrays)\n", legacyMegabytes, herdMegabytes);
+	for (int layout = 0; layout < 2; layout++) {
+		printf("  %-22s %9.4f ms/frame", layout == 0 ? "object per horse:" : "HorseHerd arrays:", results[layout].millisecondsPerFrame);
+		if (counter.isAvailable())
+			printf("  %12lld cache misses (%.2f per horse per frame)\n", results[layout].cacheMisses, (double)results[layout].cacheMisses / horseQuantity / frames);
+		else
+			printf("  cache misses n/a (no hardware counters)\n");
+	}
+	printf("  speedup: %.2fx", results[0].millisecondsPerFrame / results[1].millisecondsPerFrame);
+	if (counter.isAvailable() && results[1].cacheMisses > 0)
+		printf(", cache misses: %.2fx fewer", (double)results[0].cacheMisses / results[1].cacheMisses);
+	printf("\n");
+
+	for (int i = 0; i < horseQuantity; i++)
+		_mm_free(legacyHorses[i]);
+	if (results[0].checksum != results[1].checksum) {
+		printf("  MISMATCH: the two layouts ended in different states!\n");
+		return false;
+	}
+	return true;
+}
+
+//Compares the herd-wide heading kernel with computing cos() and sin() for every horse, checks that it agrees exactly with
+//the single horse version and reports how far it is from the standard library. Returns false if the two versions differ.
+bool runHeadingBenchmark(int horseQuantity, int frames)
+{
+	srand(1);
+	HorseHerd herd;
+	for (int i = 0; i < horseQuantity; i++) {
+		int index = herd.addHorse();
+		herd.pan[index] = randomNumber(-3600, 3600)*PI / 180;    //Pans drift far from 0 after a lot of turning.
+		herd.speed[index] = randomNumber(5, 20)*0.05f;
+		herd.posX[index] = (float)randomNumber(-50, 50);
+		herd.posZ[index] = (float)randomNumber(-50, 50);
+	}
+	vector<float> forecastsX(horseQuantity);
+	vector<float> forecastsZ(horseQuantity);
+
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		for (int i = 0; i < horseQuantity; i++) {
+			forecastsX[i] = herd.posX[i] + herd.speed[i]*cos(herd.pan[i] + PI);
+			forecastsZ[i] = herd.posZ[i] + herd.speed[i]*-sin(herd.pan[i] + PI);
+		}
+		herd.pan[frame % horseQuantity] += TURN_PER_FRAME;    //Keeps the compiler from hoisting the loop out.
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	double libraryMilliseconds = chrono::duration<double>(end - start).count() * 1000.0 / frames;
+
+	start = chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		herd.updateHeadings();
+		herd.pan[frame % horseQuantity] += TURN_PER_FRAME;
+	}
+	end = chrono::high_resolution_clock::now();
+	double kernelMilliseconds = chrono::duration<double>(end - start).count() * 1000.0 / frames;
+
+	herd.updateHeadings();
+	vector<float> kernelForecastsX(herd.forecastedPosX, herd.forecastedPosX + horseQuantity);
+	vector<float> kernelForecastsZ(herd.forecastedPosZ, herd.forecastedPosZ + horseQuantity);
+	int mismatches = 0;
+	float largestError = 0.0f;
+	for (int i = 0; i < horseQuantity; i++) {
+		herd.updateHeading(i);
+		if (herd.forecastedPosX[i] != kernelForecastsX[i] || herd.forecastedPosZ[i] != kernelForecastsZ[i])
+			mismatches++;
+		largestError = max(largestError, (float)fabs(herd.headingX[i] - cos(herd.pan[i] + PI)));
+		largestError = max(largestError, (float)fabs(herd.headingZ[i] + sin(herd.pan[i] + PI)));
+	}
+
+#if defined(HORSE_SIMD_AVX)
+	const char* kernelName = "AVX";
+#elif defined(HORSE_SIMD_SSE)
+	const char* kernelName = "SSE";
+#else
+	const char* kernelName = "scalar";
+#endif
+	printf("%7d horses, %5d frames\n", horseQuantity, frames);
+	printf("  %-22s %9.4f ms/frame\n", "cos() and sin():", libraryMilliseconds);
+	printf("  %-22s %9.4f ms/frame\n", (string(kernelName) + " heading kernel:").c_str(), kernelMilliseconds);
+	printf("  speedup: %.2fx, largest difference from the standard library: %g\n", libraryMilliseconds / kernelMilliseconds, largestError);
+	if (mismatches > 0) {
+		printf("  MISMATCH: %d horses got a different forecast from the single horse version!\n", mismatches);
+		return false;
+	}
+	return true;
+}
+
+//Helps with rotation calculations where the center is different from the limb's center.
+glm::mat4 rotateOffset(float scaleOffset, float x, float y, float z)
+{
+	return glm::translate(glm::mat4(1.0f), glm::vec3(x*scaleOffset, y*scaleOffset, z*scaleOffset));
+}
+
+//The body part matrices of one pose the way the original Horse::updateMatrices() built them, copied with its own offsets,
+//pivots, rest angles and joint indices (not the skeleton's tables, so a mistake in those shows up as a mismatch). Only the
+//inputs are read from the pose key instead of the horse, and the matrices come out in the order the tree was drawn in.
+void composeWithProducts(float scaleOffset, const float* poseKey, glm::mat4* worldMatrices, glm::mat4* modelMatrices, NormalMatrix* normalMatrices)
+{
+	const float PI = 3.14f;
+	glm::mat4 modelMatrix(1.0f);
+	glm::mat4 worldRotation = glm::make_mat4(&poseKey[Horse::MOTION_KEY_SIZE]);
+	float posX = poseKey[0];
+	float posZ = poseKey[1];
+	float pan = poseKey[2];
+	const float* jointAngles = &poseKey[3];
+	float scale = scaleOffset - 1;
+
+	glm::mat4 horseTorsoScale = glm::scale(modelMatrix, glm::vec3(0.6f + scale*0.6, 0.2f + scale*0.2, 0.15f + scale*0.15));
+	glm::mat4 horseNeckScale = glm::scale(horseTorsoScale, glm::vec3(0.5f, 0.7f, 0.75f));
+	glm::mat4 horseHeadScale = glm::scale(horseNeckScale, glm::vec3(0.8f, 0.8f, 0.95f));
+	glm::mat4 horseLimbScale = glm::scale(horseTorsoScale, glm::vec3(0.1428f, 1.5f, 0.33f));
+
+	glm::mat4 horseTorsoRot = glm::translate(worldRotation, glm::vec3(0.0f + posX, 1.0f*scaleOffset, 0.0f + posZ))
+		*glm::rotate(modelMatrix, pan, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 horseNeckRot = glm::translate(horseTorsoRot, glm::vec3(-0.75f*scaleOffset, 0.0f, 0.0f))
+		*rotateOffset(scaleOffset, 0.3f, 0.0f, 0.0f)
+		*glm::rotate(modelMatrix, -PI / 6 + jointAngles[1], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, -0.3f, 0.0f, 0.0f);
+	glm::mat4 horseHeadRot = glm::translate(horseNeckRot, glm::vec3(-0.4f*scaleOffset, 0.0f*scaleOffset, 0.0f))
+		*rotateOffset(scaleOffset, 0.2f, 0.0f, 0.0f)
+		*glm::rotate(modelMatrix, PI / 2 + jointAngles[0], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, -0.2f, 0.0f, 0.0f);
+	glm::mat4 horseLeftUpperArmRot = glm::translate(horseTorsoRot, glm::vec3(-0.45f*scaleOffset, -0.3f*scaleOffset, 0.1f*scaleOffset))
+		*rotateOffset(scaleOffset, 0.0f, 0.25f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[7], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.25f, 0.0f);
+	glm::mat4 horseLeftLowerArmRot = glm::translate(horseLeftUpperArmRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
+		*rotateOffset(scaleOffset, 0.0f, 0.2f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[6], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.2f, 0.0f);
+	glm::mat4 horseRightUpperArmRot = glm::translate(horseTorsoRot, glm::vec3(-0.45f*scaleOffset, -0.3f*scaleOffset, -0.1f*scaleOffset))
+		*rotateOffset(scaleOffset, 0.0f, 0.25f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[3], glm::vec3(0.0f, 0.0f, 1.0f))*rotateOffset(scaleOffset, 0.0f, -0.25f, 0.0f);
+	glm::mat4 horseRightLowerArmRot = glm::translate(horseRightUpperArmRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
+		*rotateOffset(scaleOffset, 0.0f, 0.2f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[2], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.2f, 0.0f);
+	glm::mat4 horseLeftUpperLegRot = glm::translate(horseTorsoRot, glm::vec3(0.45f*scaleOffset, -0.3f*scaleOffset, 0.1f*scaleOffset))
+		*rotateOffset(scaleOffset, 0.0f, 0.25f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[9], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.25f, 0.0f);
+	glm::mat4 horseLeftLowerLegRot = glm::translate(horseLeftUpperLegRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
+		*rotateOffset(scaleOffset, 0.0f, 0.2f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[8], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.2f, 0.0f);
+	glm::mat4 horseRightUpperLegRot = glm::translate(horseTorsoRot, glm::vec3(0.45f*scaleOffset, -0.3f*scaleOffset, -0.1f*scaleOffset))
+		*rotateOffset(scaleOffset, 0.0f, 0.25f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[5], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.25f, 0.0f);
+	glm::mat4 horseRightLowerLegRot = glm::translate(horseRightUpperLegRot, glm::vec3(0.0f, -0.4f*scaleOffset, 0.0f))
+		*rotateOffset(scaleOffset, 0.0f, 0.2f, 0.0f)
+		*glm::rotate(modelMatrix, jointAngles[4], glm::vec3(0.0f, 0.0f, 1.0f))
+		*rotateOffset(scaleOffset, 0.0f, -0.2f, 0.0f);
+
+	//Drawn as rotation-translation times scale, in pre-order from the torso.
+	glm::mat4 rotTrans[] = { horseTorsoRot, horseNeckRot, horseHeadRot, horseLeftUpperArmRot, horseLeftLowerArmRot, horseRightUpperArmRot,
+		horseRightLowerArmRot, horseLeftUpperLegRot, horseLeftLowerLegRot, horseRightUpperLegRot, horseRightLowerLegRot };
+	glm::mat4 scales[] = { horseTorsoScale, horseNeckScale, horseHeadScale, horseLimbScale, horseLimbScale, horseLimbScale,
+		horseLimbScale, horseLimbScale, horseLimbScale, horseLimbScale, horseLimbScale };
+	for (int i = 0; i < bodyPartQuantity; i++) {
+		worldMatrices[i] = rotTrans[i];
+		modelMatrices[i] = rotTrans[i] * scales[i];
+		for (int j = 0; j < 3; j++)
+			normalMatrices[i].columns[j] = rotTrans[i][j] * (1.0f / scales[i][j][j]);
+	}
+}
+
+//Largest difference between two arrays of floats, relative to the expected values (absolute where they are below 1).
+float largestRelativeDifference(const float* expected, const float* actual, int quantity)
+{
+	float largestDifference = 0.0f;
+	for (int i = 0; i < quantity; i++)
+		largestDifference = max(largestDifference, (float)fabs(actual[i] - expected[i]) / max(1.0f, (float)fabs(expected[i])));
+	return largestDifference;
+}
+
+//Compares building the body part matrices of every horse from glm matrix products with the closed form kernel of
+//Horse::evaluatePose() (every body part computed, as for a horse that moved all of its joints), and checks that both give
+//the same matrices up to rounding. Returns false if they differ by more than JOINT_TOLERANCE.
+bool runJointBenchmark(int horseQuantity, int frames)
+{
+	srand(1);
+	HorseHerd herd;
+	vector<Horse*> horses;
+	vector<float> poseKeys(horseQuantity*Horse::POSE_KEY_SIZE);
+	for (int i = 0; i < horseQuantity; i++) {
+		horses.push_back(new Horse(&herd, i + 1));
+		float* poseKey = &poseKeys[i*Horse::POSE_KEY_SIZE];
+		horses[i]->getPoseKey(poseKey);
+		for (int j = 3; j < Horse::MOTION_KEY_SIZE; j++)
+			poseKey[j] = randomNumber(-100, 100)*0.01f;    //Any joint angles, not just the first frame of a gait.
+		glm::mat4 worldRotation = glm::rotate(glm::mat4(1.0f), randomNumber(-314, 314)*0.01f, glm::vec3(0.0f, 1.0f, 0.0f))
+			*glm::rotate(glm::mat4(1.0f), randomNumber(-50, 50)*0.01f, glm::vec3(1.0f, 0.0f, 0.0f));
+		memcpy(&poseKey[Horse::MOTION_KEY_SIZE], glm::value_ptr(worldRotation), 16 * sizeof(float));
+	}
+
+	vector<float> startPoseKeys(poseKeys);
+	vector<glm::mat4> worldMatrices[2];
+	vector<glm::mat4> modelMatrices[2];
+	vector<NormalMatrix> normalMatrices[2];
+	double milliseconds[2];
+	for (int method = 0; method < 2; method++) {
+		worldMatrices[method].resize(horseQuantity*bodyPartQuantity);
+		modelMatrices[method].resize(horseQuantity*bodyPartQuantity);
+		normalMatrices[method].resize(horseQuantity*bodyPartQuantity);
+
+		//One joint angle changes every frame so the work can't be hoisted out of the loop. Both methods start from the same
+		//pose keys, so they also end on the same ones and are compared on those.
+		poseKeys = startPoseKeys;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			for (int i = 0; i < horseQuantity; i++) {
+				const float* poseKey = &poseKeys[i*Horse::POSE_KEY_SIZE];
+				int first = i*bodyPartQuantity;
+				if (method == 0)
+					composeWithProducts(horses[i]->getScaleOffset(), poseKey, &worldMatrices[0][first], &modelMatrices[0][first],
+						&normalMatrices[0][first]);
+				else
+					horses[i]->evaluatePose(poseKey, NULL, &worldMatrices[1][first], &modelMatrices[1][first], &normalMatrices[1][first]);
+			}
+			poseKeys[(frame % horseQuantity)*Horse::POSE_KEY_SIZE + 3] += TURN_PER_FRAME;
+		}
+		chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+		milliseconds[method] = chrono::duration<double>(end - start).count() * 1000.0 / frames;
+	}
+
+	float largestDifference = max(
+		largestRelativeDifference(&modelMatrices[0][0][0][0], &modelMatrices[1][0][0][0], modelMatrices[0].size() * 16),
+		largestRelativeDifference(&normalMatrices[0][0].columns[0][0], &normalMatrices[1][0].columns[0][0], normalMatrices[0].size() * 12));
+	printf("%7d horses, %5d frames\n", horseQuantity, frames);
+	printf("  %-22s %9.4f ms/frame (%.1f ns per horse)\n", "glm matrix products:", milliseconds[0], milliseconds[0] * 1000000.0 / horseQuantity);
+	printf("  %-22s %9.4f ms/frame (%.1f ns per horse)\n", (string("closed form, ") + SimdMatrix::getBackendName() + ":").c_str(), milliseconds[1],
+		milliseconds[1] * 1000000.0 / horseQuantity);
+	printf("  speedup: %.2fx, largest difference from the matrix products: %g\n", milliseconds[0] / milliseconds[1], largestDifference);
+
+	for (int i = 0; i < horseQuantity; i++)
+		delete horses[i];
+	if (largestDifference > JOINT_TOLERANCE) {
+		printf("  MISMATCH: the closed form kernel is further than %g from the matrix products!\n", JOINT_TOLERANCE);
+		return false;
+	}
+	return true;
+}
+
+//Product of CHAIN_LENGTH matrices starting at first, on glm::mat4 and on the matrix backend.
+glm::mat4 multiplyChain(const vector<glm::mat4> &matrices, int first)
+{
+	glm::mat4 product = matrices[first];
+	for (int i = 1; i < CHAIN_LENGTH; i++)
+		product = product * matrices[(first + i) % CHAIN_MATRIX_QUANTITY];
+	return product;
+}
+
+glm::mat4 multiplyChainOnBackend(const vector<glm::mat4> &matrices, int first)
+{
+	SimdMatrix product(matrices[first]);
+	for (int i = 1; i < CHAIN_LENGTH; i++)
+		product = product * SimdMatrix(matrices[(first + i) % CHAIN_MATRIX_QUANTITY]);
+	return product.toMat4();
+}
+
+//Compares composing chains of transforms (like the camera's) on glm::mat4 with SimdMatrix, converting every matrix on the
+//way in and the product on the way out like the game does. Returns false if the products differ by more than JOINT_TOLERANCE.
+bool runMatrixBenchmark(int chainQuantity)
+{
+	srand(1);
+	vector<glm::mat4> matrices;
+	for (int i = 0; i < CHAIN_MATRIX_QUANTITY; i++)
+		matrices.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(randomNumber(-50, 50), randomNumber(-50, 50), randomNumber(-50, 50))*0.1f)
+			*glm::rotate(glm::mat4(1.0f), randomNumber(-314, 314)*0.01f, glm::normalize(glm::vec3(randomNumber(1, 9), randomNumber(-9, 9), randomNumber(-9, 9)))));
+
+	//The products are summed up so none of them can be skipped.
+	double milliseconds[2];
+	glm::mat4 sums[2];
+	for (int method = 0; method < 2; method++) {
+		glm::mat4 sum(0.0f);
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < chainQuantity; i++)
+			sum += method == 0 ? multiplyChain(matrices, i % CHAIN_MATRIX_QUANTITY) : multiplyChainOnBackend(matrices, i % CHAIN_MATRIX_QUANTITY);
+		chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+		milliseconds[method] = chrono::duration<double>(end - start).count() * 1000.0;
+		sums[method] = sum;
+	}
+
+	float largestDifference = 0.0f;
+	for (int i = 0; i < CHAIN_MATRIX_QUANTITY; i++) {
+		glm::mat4 expected = multiplyChain(matrices, i);
+		glm::mat4 actual = multiplyChainOnBackend(matrices, i);
+		largestDifference = max(largestDifference, largestRelativeDifference(&expected[0][0], &actual[0][0], 16));
+	}
+
+	printf("%7d products of %d matrices\n", chainQuantity, CHAIN_LENGTH);
+	printf("  %-22s %9.4f ms (%.1f ns per product)\n", "glm::mat4:", milliseconds[0], milliseconds[0] * 1000000.0 / chainQuantity);
+	printf("  %-22s %9.4f ms (%.1f ns per product)\n", (string(SimdMatrix::getBackendName()) + " SimdMatrix:").c_str(), milliseconds[1],
+		milliseconds[1] * 1000000.0 / chainQuantity);
+	printf("  speedup: %.2fx, largest difference from glm::mat4: %g (sums %g and %g)\n", milliseconds[0] / milliseconds[1], largestDifference,
+		sums[0][3][3], sums[1][3][3]);
+	if (largestDifference > JOINT_TOLERANCE) {
+		printf("  MISMATCH: SimdMatrix is further than %g from glm::mat4!\n", JOINT_TOLERANCE);
+		return false;
+	}
+	return true;
+}
+
+void printUsage()
+{
+	printf("Usage: HorseBenchmark [--horses N] [--frames F]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int horseQuantity = 0;
+	int frames = 0;
+
+	//Read the command line options (each one is followed by its value).
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && strcmp(argv[i], "--horses") == 0)
+			horseQuantity = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0)
+			frames = atoi(argv[++i]);
+		else {
+			printUsage();
+			return -1;
+		}
+	}
+
+	const int DEFAULT_HERD_SIZES[] = { 1000, 10000, 100000 };
+	int herdSizeQuantity = horseQuantity > 0 ? 1 : 3;
+	bool passed = true;
+	printf("Movement and collision detection, object per horse vs HorseHerd arrays:\n");
+	for (int i = 0; i < herdSizeQuantity; i++) {
+		int quantity = horseQuantity > 0 ? horseQuantity : DEFAULT_HERD_SIZES[i];
+		passed = runLayoutBenchmark(quantity, frames > 0 ? frames : max(20, 2000000 / quantity)) && passed;
+	}
+	printf("\nHeadings and forecasts:\n");
+	for (int i = 0; i < herdSizeQuantity; i++) {
+		int quantity = horseQuantity > 0 ? horseQuantity : DEFAULT_HERD_SIZES[i];
+		passed = runHeadingBenchmark(quantity, frames > 0 ? frames : max(20, 20000000 / quantity)) && passed;
+	}
+	printf("\nBody part matrices:\n");
+	for (int i = 0; i < herdSizeQuantity; i++) {
+		int quantity = horseQuantity > 0 ? horseQuantity : DEFAULT_HERD_SIZES[i];
+		passed = runJointBenchmark(quantity, frames > 0 ? frames : max(20, 2000000 / quantity)) && passed;
+	}
+	printf("\nMatrix backend:\n");
+	passed = runMatrixBenchmark(frames > 0 ? frames*CHAIN_MATRIX_QUANTITY : 1000000) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include <algorithm>        //For copy() and equal().
+#include <math.h>           //For floor() and ceil().
+#include "HorseCuller.h"
+#include "Profiler.h"
+
+HorseCuller::HorseCuller()
+{
+	horseQuantity = 0;
+	cameraVisibleQuantity = 0;
+	lightVisibleQuantity = 0;
+	culledQuantity = 0;
+	haveLightCastersChanged = true;
+}
+
+//Test every evaluated horse's bounding sphere against both frustums and copy the body parts of the visible ones.
+void HorseCuller::cull(PoseEvaluator* poses, Frustum& camera, Frustum& light)
+{
+	PROFILE_ZONE("Cull horses");
+
+	const glm::vec4* spheres = poses->getBoundingSpheres();
+	horseQuantity = poses->getHorseQuantity();
+	cameraHorses.clear();
+	sharedHorses.clear();
+	lightHorses.clear();
+	for (int i = 0; i < horseQuantity; i++) {
+		bool isSeenByCamera = camera.isSphereVisible(spheres[i]);
+		bool isSeenByLight = light.isSphereVisible(spheres[i]);
+		if (isSeenByCamera && isSeenByLight)
+			sharedHorses.push_back(i);
+		else if (isSeenByCamera)
+			cameraHorses.push_back(i);
+		else if (isSeenByLight)
+			lightHorses.push_back(i);
+	}
+	cameraVisibleQuantity = cameraHorses.size() + sharedHorses.size();
+	lightVisibleQuantity = sharedHorses.size() + lightHorses.size();
+	culledQuantity = horseQuantity - cameraHorses.size() - sharedHorses.size() - lightHorses.size();
+
+	int drawnQuantity = horseQuantity - culledQuantity;
+	modelMatrices.resize(drawnQuantity*bodyPartQuantity);
+	normalMatrices.resize(drawnQuantity*bodyPartQuantity);
+	colors.resize(drawnQuantity*bodyPartQuantity);
+	int instance = 0;
+	copyHorses(poses, cameraHorses, instance);
+	copyHorses(poses, sharedHorses, instance);
+	copyHorses(poses, lightHorses, instance);
+
+	//A shadow map drawn from the same casters in the same poses would come out the same.
+	int lightFirstInstance = getLightFirstInstance();
+	int lightInstanceQuantity = getLightInstanceQuantity();
+	haveLightCastersChanged = lightInstanceQuantity != lightCasterMatrices.size()
+		|| !equal(lightCasterMatrices.begin(), lightCasterMatrices.end(), modelMatrices.begin() + lightFirstInstance);
+	if (haveLightCastersChanged)
+		lightCasterMatrices.assign(modelMatrices.begin() + lightFirstInstance, modelMatrices.begin() + lightFirstInstance + lightInstanceQuantity);
+}
+
+//Smallest value of numerator/w for w between wMin and wMax (both positive).
+static float getSmallestRatio(float numerator, float wMin, float wMax)
+{
+	return numerator >= 0.0f ? numerator / wMax : numerator / wMin;
+}
+
+static float getLargestRatio(float numerator, float wMin, float wMax)
+{
+	return numerator >= 0.0f ? numerator / wMin : numerator / wMax;
+}
+
+//Crop the light's projection to the part of its view the light casters of the last cull fall in, so the shadow map's
+//resolution isn't spent on empty field. Nothing outside that window can be shadowed by a caster. The window is widened to
+//steps of 1/LIGHT_WINDOW_STEPS of the whole view, so the projection only changes when a caster crosses a step and the
+//same casters always give the same matrix. Gives the projection back unchanged when there is nothing to fit.
+glm::mat4 HorseCuller::fitLightProjection(PoseEvaluator* poses, const glm::mat4& lightView, const glm::mat4& lightProjection)
+{
+	glm::mat4 viewProjection = lightProjection * lightView;
+	glm::vec4 rowX = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 rowY = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 rowW = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+	float lengthX = glm::length(glm::vec3(rowX));
+	float lengthY = glm::length(glm::vec3(rowY));
+	float lengthW = glm::length(glm::vec3(rowW));
+
+	//Bound x, y and w of each bounding sphere in clip space separately, then the window in normalized device coordinates.
+	const glm::vec4* spheres = poses->getBoundingSpheres();
+	float left = 1.0f, right = -1.0f, bottom = 1.0f, top = -1.0f;
+	for (int group = 0; group < 2; group++) {
+		vector<int>& horses = group == 0 ? sharedHorses : lightHorses;
+		for (int i = 0; i < horses.size(); i++) {
+			glm::vec4 sphere = spheres[horses[i]];
+			glm::vec4 center = glm::vec4(sphere.x, sphere.y, sphere.z, 1.0f);
+			float x = glm::dot(rowX, center), y = glm::dot(rowY, center), w = glm::dot(rowW, center);
+			float wMin = w - sphere.w*lengthW, wMax = w + sphere.w*lengthW;
+			if (wMin <= 0.0f)  //Reaches behind the light, can't be bounded.
+				return lightProjection;
+			left = glm::min(left, getSmallestRatio(x - sphere.w*lengthX, wMin, wMax));
+			right = glm::max(right, getLargestRatio(x + sphere.w*lengthX, wMin, wMax));
+			bottom = glm::min(bottom, getSmallestRatio(y - sphere.w*lengthY, wMin, wMax));
+			top = glm::max(top, getLargestRatio(y + sphere.w*lengthY, wMin, wMax));
+		}
+	}
+
+	float step = 2.0f / LIGHT_WINDOW_STEPS;
+	left = glm::max(-1.0f, floor((left + 1.0f) / step)*step - 1.0f);
+	bottom = glm::max(-1.0f, floor((bottom + 1.0f) / step)*step - 1.0f);
+	right = glm::min(1.0f, ceil((right + 1.0f) / step)*step - 1.0f);
+	top = glm::min(1.0f, ceil((top + 1.0f) / step)*step - 1.0f);
+	if (left >= right || bottom >= top || (left == -1.0f && right == 1.0f && bottom == -1.0f && top == 1.0f))
+		return lightProjection;
+
+	//Map the window to the whole of clip space.
+	glm::mat4 crop;
+	crop[0][0] = 2.0f / (right - left);
+	crop[1][1] = 2.0f / (top - bottom);
+	crop[3][0] = -(right + left) / (right - left);
+	crop[3][1] = -(top + bottom) / (top - bottom);
+	return crop * lightProjection;
+}
+
+//Append the body parts of horses to the draw buffers, starting at instance.
+void HorseCuller::copyHorses(PoseEvaluator* poses, vector<int>& horses, int& instance)
+{
+	const glm::mat4* sourceModelMatrices = poses->getModelMatrices();
+	const NormalMatrix* sourceNormalMatrices = poses->getNormalMatrices();
+	const glm::vec4* sourceColors = poses->getColors();
+	for (int i = 0; i < horses.size(); i++) {
+		int source = horses[i] * bodyPartQuantity;
+		copy(sourceModelMatrices + source, sourceModelMatrices + source + bodyPartQuantity, modelMatrices.begin() + instance);
+		copy(sourceNormalMatrices + source, sourceNormalMatrices + source + bodyPartQuantity, normalMatrices.begin() + instance);
+		copy(sourceColors + source, sourceColors + source + bodyPartQuantity, colors.begin() + instance);
+		instance += bodyPartQuantity;
+	}
+}
+
+//GETTERS
+//Horses inside the camera's frustum.
+int HorseCuller::getCameraVisibleQuantity()
+{
+	return cameraVisibleQuantity;
+}
+
+//Horses inside the light's frustum (the ones that can cast a shadow on the shadow map).
+int HorseCuller::getLightVisibleQuantity()
+{
+	return lightVisibleQuantity;
+}
+
+//Horses neither pass draws.
+int HorseCuller::getCulledQuantity()
+{
+	return culledQuantity;
+}
+
+//Whether the body parts the shadow pass draws differ from the last cull's (when they don't, neither does the shadow map).
+bool HorseCuller::getHaveLightCastersChanged()
+{
+	return haveLightCastersChanged;
+}
+
+//Body parts in the draw buffers.
+int HorseCuller::getInstanceQuantity()
+{
+	return modelMatrices.size();
+}
+
+int HorseCuller::getCameraFirstInstance()
+{
+	return 0;
+}
+
+int HorseCuller::getCameraInstanceQuantity()
+{
+	return cameraVisibleQuantity*bodyPartQuantity;
+}
+
+int HorseCuller::getLightFirstInstance()
+{
+	return cameraHorses.size()*bodyPartQuantity;
+}
+
+int HorseCuller::getLightInstanceQuantity()
+{
+	return lightVisibleQuantity*bodyPartQuantity;
+}
+
+const glm::mat4* HorseCuller::getModelMatrices()
+{
+	return modelMatrices.empty() ? NULL : &modelMatrices[0];
+}
+
+const NormalMatrix* HorseCuller::getNormalMatrices()
+{
+	return normalMatrices.empty() ? NULL : &normalMatrices[0];
+}
+
+const glm::vec4* HorseCuller::getColors()
+{
+	return colors.empty() ? NULL : &colors[0];
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "PoseEvaluator.h"
+#include "Frustum.h"
+
+using namespace std;
+
+//Picks the horses the camera and the light can see and lays their body parts out so both render passes draw one
+//contiguous range from a single upload: horses only the camera sees, then horses both see, then horses only the light
+//sees. The main pass draws the first two groups and the shadow pass the last two. Horses neither sees aren't copied.
+class HorseCuller {
+	private:
+		static const int LIGHT_WINDOW_STEPS = 8;  //Steps the fitted light window snaps to across the light's whole view.
+
+		vector<glm::mat4> modelMatrices;    //bodyPartQuantity per drawn horse, in draw order.
+		vector<NormalMatrix> normalMatrices;
+		vector<glm::vec4> colors;
+		vector<int> cameraHorses;           //Horses in each group (scratch space kept between frames).
+		vector<int> sharedHorses;
+		vector<int> lightHorses;
+		vector<glm::mat4> lightCasterMatrices; //Body parts the shadow pass drew from at the last cull.
+		bool haveLightCastersChanged;
+		int horseQuantity;
+		int cameraVisibleQuantity;
+		int lightVisibleQuantity;
+		int culledQuantity;
+
+		void copyHorses(PoseEvaluator* poses, vector<int>& horses, int& instance);
+	public:
+		HorseCuller();
+		void cull(PoseEvaluator* poses, Frustum& camera, Frustum& light);
+		glm::mat4 fitLightProjection(PoseEvaluator* poses, const glm::mat4& lightView, const glm::mat4& lightProjection);
+
+		//GETTERS
+		int getCameraVisibleQuantity();
+		int getLightVisibleQuantity();
+		int getCulledQuantity();
+		bool getHaveLightCastersChanged();
+		int getInstanceQuantity();
+		int getCameraFirstInstance();
+		int getCameraInstanceQuantity();
+		int getLightFirstInstance();
+		int getLightInstanceQuantity();
+		const glm::mat4* getModelMatrices();
+		const NormalMatrix* getNormalMatrices();
+		const glm::vec4* getColors();
+};
\ No newline at end of file
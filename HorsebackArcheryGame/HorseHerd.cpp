@@ -0,0 +1,316 @@
+#include <string.h>         //For memcpy() and memset().
+#include <xmmintrin.h>      //For _mm_malloc() and _mm_free().
+#include "HorseHerd.h"
+
+#if defined(HORSE_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(HORSE_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+//Sine and cosine are computed with the same polynomial (Cephes' single precision sinf/cosf) in every version of the
+//kernel instead of the standard library's, which differ between platforms and can't be vectorized.
+static const float FOUR_OVER_PI = 1.27323954473516f;
+static const float PI_OVER_FOUR_PART1 = -0.78515625f;     //-PI/4 split in three parts to reduce the angle with extra precision.
+static const float PI_OVER_FOUR_PART2 = -2.4187564849853515625e-4f;
+static const float PI_OVER_FOUR_PART3 = -3.77489497744594108e-8f;
+static const float SIN_COEFFICIENT0 = -1.9515295891e-4f;
+static const float SIN_COEFFICIENT1 = 8.3321608736e-3f;
+static const float SIN_COEFFICIENT2 = -1.6666654611e-1f;
+static const float COS_COEFFICIENT0 = 2.443315711809948e-5f;
+static const float COS_COEFFICIENT1 = -1.388731625493765e-3f;
+static const float COS_COEFFICIENT2 = 4.166664568298827e-2f;
+
+static void sinCos(float angle, float &sinValue, float &cosValue)
+{
+	//Reduce the angle to -PI/4 to PI/4 around the nearest even multiple of PI/4 (the octant picks the polynomial and the signs).
+	float x = angle < 0.0f ? -angle : angle;
+	int octant = (int)(x * FOUR_OVER_PI);
+	octant = (octant + 1) & ~1;
+	float y = (float)octant;
+	x = ((x + y * PI_OVER_FOUR_PART1) + y * PI_OVER_FOUR_PART2) + y * PI_OVER_FOUR_PART3;
+
+	float z = x * x;
+	float cosPolynomial = COS_COEFFICIENT0 * z;
+	cosPolynomial = (cosPolynomial + COS_COEFFICIENT1) * z;
+	cosPolynomial = (cosPolynomial + COS_COEFFICIENT2) * z;
+	cosPolynomial = cosPolynomial * z;
+	cosPolynomial = cosPolynomial - z * 0.5f;
+	cosPolynomial = cosPolynomial + 1.0f;
+	float sinPolynomial = SIN_COEFFICIENT0 * z;
+	sinPolynomial = (sinPolynomial + SIN_COEFFICIENT1) * z;
+	sinPolynomial = (sinPolynomial + SIN_COEFFICIENT2) * z;
+	sinPolynomial = sinPolynomial * x + x;
+
+	bool swapPolynomials = (octant & 2) != 0;
+	sinValue = swapPolynomials ? cosPolynomial : sinPolynomial;
+	cosValue = swapPolynomials ? sinPolynomial : cosPolynomial;
+	if ((angle < 0.0f) != ((octant & 4) != 0))
+		sinValue = -sinValue;
+	if (((octant - 2) & 4) == 0)
+		cosValue = -cosValue;
+}
+
+#if defined(HORSE_SIMD_AVX) || defined(HORSE_SIMD_SSE)
+//Octant bookkeeping of sinCos() for 4 lanes: rounds the octants up to even and builds the masks picking the polynomials
+//(all bits set where they are swapped) and flipping the signs (sign bit set where the sign flips).
+static inline void octantMasks(__m128i octant, __m128i &roundedOctant, __m128i &swapMask, __m128i &sinSignFlip, __m128i &cosSignFlip)
+{
+	roundedOctant = _mm_andnot_si128(_mm_set1_epi32(1), _mm_add_epi32(octant, _mm_set1_epi32(1)));
+	swapMask = _mm_cmpeq_epi32(_mm_and_si128(roundedOctant, _mm_set1_epi32(2)), _mm_set1_epi32(2));
+	sinSignFlip = _mm_slli_epi32(_mm_and_si128(roundedOctant, _mm_set1_epi32(4)), 29);
+	cosSignFlip = _mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(roundedOctant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29);
+}
+#endif
+
+#if defined(HORSE_SIMD_AVX)
+//sinCos() for 8 lanes at once. AVX has no integer operations so the octants are handled as two halves of 4.
+static inline void sinCos8(__m256 angle, __m256 &sinValue, __m256 &cosValue)
+{
+	__m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+	__m256 angleSign = _mm256_and_ps(angle, signMask);
+	__m256 x = _mm256_andnot_ps(signMask, angle);
+	__m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+
+	__m128i roundedOctant[2], swapMask[2], sinSignFlip[2], cosSignFlip[2];
+	octantMasks(_mm256_castsi256_si128(octant), roundedOctant[0], swapMask[0], sinSignFlip[0], cosSignFlip[0]);
+	octantMasks(_mm256_extractf128_si256(octant, 1), roundedOctant[1], swapMask[1], sinSignFlip[1], cosSignFlip[1]);
+	__m256 y = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(roundedOctant[0]), roundedOctant[1], 1));
+	__m256 swap = _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(swapMask[0]), swapMask[1], 1));
+	__m256 sinSign = _mm256_xor_ps(angleSign, _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(sinSignFlip[0]), sinSignFlip[1], 1)));
+	__m256 cosSign = _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(cosSignFlip[0]), cosSignFlip[1], 1));
+
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART1)));
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART2)));
+	x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(PI_OVER_FOUR_PART3)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 cosPolynomial = _mm256_mul_ps(_mm256_set1_ps(COS_COEFFICIENT0), z);
+	cosPolynomial = _mm256_mul_ps(_mm256_add_ps(cosPolynomial, _mm256_set1_ps(COS_COEFFICIENT1)), z);
+	cosPolynomial = _mm256_mul_ps(_mm256_add_ps(cosPolynomial, _mm256_set1_ps(COS_COEFFICIENT2)), z);
+	cosPolynomial = _mm256_mul_ps(cosPolynomial, z);
+	cosPolynomial = _mm256_sub_ps(cosPolynomial, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+	cosPolynomial = _mm256_add_ps(cosPolynomial, _mm256_set1_ps(1.0f));
+	__m256 sinPolynomial = _mm256_mul_ps(_mm256_set1_ps(SIN_COEFFICIENT0), z);
+	sinPolynomial = _mm256_mul_ps(_mm256_add_ps(sinPolynomial, _mm256_set1_ps(SIN_COEFFICIENT1)), z);
+	sinPolynomial = _mm256_mul_ps(_mm256_add_ps(sinPolynomial, _mm256_set1_ps(SIN_COEFFICIENT2)), z);
+	sinPolynomial = _mm256_add_ps(_mm256_mul_ps(sinPolynomial, x), x);
+
+	sinValue = _mm256_xor_ps(_mm256_blendv_ps(sinPolynomial, cosPolynomial, swap), sinSign);
+	cosValue = _mm256_xor_ps(_mm256_blendv_ps(cosPolynomial, sinPolynomial, swap), cosSign);
+}
+#elif defined(HORSE_SIMD_SSE)
+//sinCos() for 4 lanes at once.
+static inline void sinCos4(__m128 angle, __m128 &sinValue, __m128 &cosValue)
+{
+	__m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+	__m128 angleSign = _mm_and_ps(angle, signMask);
+	__m128 x = _mm_andnot_ps(signMask, angle);
+
+	__m128i roundedOctant, swapMask, sinSignFlip, cosSignFlip;
+	octantMasks(_mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI))), roundedOctant, swapMask, sinSignFlip, cosSignFlip);
+	__m128 y = _mm_cvtepi32_ps(roundedOctant);
+	__m128 swap = _mm_castsi128_ps(swapMask);
+	__m128 sinSign = _mm_xor_ps(angleSign, _mm_castsi128_ps(sinSignFlip));
+	__m128 cosSign = _mm_castsi128_ps(cosSignFlip);
+
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART1)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART2)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PI_OVER_FOUR_PART3)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 cosPolynomial = _mm_mul_ps(_mm_set1_ps(COS_COEFFICIENT0), z);
+	cosPolynomial = _mm_mul_ps(_mm_add_ps(cosPolynomial, _mm_set1_ps(COS_COEFFICIENT1)), z);
+	cosPolynomial = _mm_mul_ps(_mm_add_ps(cosPolynomial, _mm_set1_ps(COS_COEFFICIENT2)), z);
+	cosPolynomial = _mm_mul_ps(cosPolynomial, z);
+	cosPolynomial = _mm_sub_ps(cosPolynomial, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	cosPolynomial = _mm_add_ps(cosPolynomial, _mm_set1_ps(1.0f));
+	__m128 sinPolynomial = _mm_mul_ps(_mm_set1_ps(SIN_COEFFICIENT0), z);
+	sinPolynomial = _mm_mul_ps(_mm_add_ps(sinPolynomial, _mm_set1_ps(SIN_COEFFICIENT1)), z);
+	sinPolynomial = _mm_mul_ps(_mm_add_ps(sinPolynomial, _mm_set1_ps(SIN_COEFFICIENT2)), z);
+	sinPolynomial = _mm_add_ps(_mm_mul_ps(sinPolynomial, x), x);
+
+	sinValue = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosPolynomial), _mm_andnot_ps(swap, sinPolynomial)), sinSign);
+	cosValue = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sinPolynomial), _mm_andnot_ps(swap, cosPolynomial)), cosSign);
+}
+#endif
+
+HorseHerd::HorseHerd()
+{
+	quantity = 0;
+	capacity = 0;
+	posX = NULL;
+	posZ = NULL;
+	pan = NULL;
+	speed = NULL;
+	collisionRadius = NULL;
+	overallStatus = NULL;
+	headingX = NULL;
+	headingZ = NULL;
+	forecastedPosX = NULL;
+	forecastedPosZ = NULL;
+	isMoving = NULL;
+	for (int i = 0; i < 16; i++)
+		worldRotation[i] = i % 5 == 0 ? 1.0f : 0.0f;
+	randomSeed = 0;
+	tick = 0;
+}
+
+//Make room for one more horse and give back its index. Its properties are set by the horse itself. Capacity stays a
+//multiple of 8 horses (one AVX register) so the kernels never need to handle a partial group.
+int HorseHerd::addHorse()
+{
+	if (quantity == capacity)
+		grow(capacity == 0 ? 64 : capacity * 2);
+	return quantity++;
+}
+
+int HorseHerd::getQuantity()
+{
+	return quantity;
+}
+
+float HorseHerd::getLargestCollisionRadius()
+{
+	float largestRadius = 0.0f;
+	for (int i = 0; i < quantity; i++)
+		if (collisionRadius[i] > largestRadius)
+			largestRadius = collisionRadius[i];
+	return largestRadius;
+}
+
+//Headings and forecasts of the whole herd, as many horses at a time as the instruction set allows (unused slots past the
+//last horse are zeroed, so the last group of horses can be processed whole).
+void HorseHerd::updateHeadings()
+{
+	updateHeadings(0, quantity);
+}
+
+//Headings and forecasts of the horses from begin to end, so parts of the herd can be refreshed on different threads. begin
+//has to be a multiple of 8 (the vector versions go through whole groups of 8 or 4 horses).
+void HorseHerd::updateHeadings(int begin, int end)
+{
+#if defined(HORSE_SIMD_AVX)
+	for (int i = begin; i < end; i += 8) {
+		__m256 sinValue, cosValue;
+		sinCos8(_mm256_add_ps(_mm256_load_ps(pan + i), _mm256_set1_ps(PI)), sinValue, cosValue);
+		__m256 headingXValue = cosValue;
+		__m256 headingZValue = _mm256_xor_ps(sinValue, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000)));
+		_mm256_store_ps(headingX + i, headingXValue);
+		_mm256_store_ps(headingZ + i, headingZValue);
+		_mm256_store_ps(forecastedPosX + i, _mm256_add_ps(_mm256_load_ps(posX + i), _mm256_mul_ps(_mm256_load_ps(speed + i), headingXValue)));
+		_mm256_store_ps(forecastedPosZ + i, _mm256_add_ps(_mm256_load_ps(posZ + i), _mm256_mul_ps(_mm256_load_ps(speed + i), headingZValue)));
+	}
+#elif defined(HORSE_SIMD_SSE)
+	for (int i = begin; i < end; i += 4) {
+		__m128 sinValue, cosValue;
+		sinCos4(_mm_add_ps(_mm_load_ps(pan + i), _mm_set1_ps(PI)), sinValue, cosValue);
+		__m128 headingXValue = cosValue;
+		__m128 headingZValue = _mm_xor_ps(sinValue, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+		_mm_store_ps(headingX + i, headingXValue);
+		_mm_store_ps(headingZ + i, headingZValue);
+		_mm_store_ps(forecastedPosX + i, _mm_add_ps(_mm_load_ps(posX + i), _mm_mul_ps(_mm_load_ps(speed + i), headingXValue)));
+		_mm_store_ps(forecastedPosZ + i, _mm_add_ps(_mm_load_ps(posZ + i), _mm_mul_ps(_mm_load_ps(speed + i), headingZValue)));
+	}
+#else
+	for (int i = begin; i < end; i++)
+		updateHeading(i);
+#endif
+}
+
+//Heading and forecast of a single horse (used when a horse turns between two herd-wide passes).
+void HorseHerd::updateHeading(int i)
+{
+	float sinValue, cosValue;
+	sinCos(pan[i] + PI, sinValue, cosValue);
+	headingX[i] = cosValue;
+	headingZ[i] = -sinValue;
+	getForecastedPosition(i, forecastedPosX[i], forecastedPosZ[i]);
+}
+
+void HorseHerd::getForecastedPosition(int i, float &forecastedPosXParam, float &forecastedPosZParam)
+{
+	forecastedPosXParam = posX[i] + speed[i] * headingX[i];
+	forecastedPosZParam = posZ[i] + speed[i] * headingZ[i];
+}
+
+//Clamping with min/max gives the exact same positions as the comparisons in Horse::checkBounds().
+void HorseHerd::integrate()
+{
+#if defined(HORSE_SIMD_AVX)
+	__m256 lowerBound = _mm256_set1_ps(-FIELD_HALF_SIZE);
+	__m256 upperBound = _mm256_set1_ps(FIELD_HALF_SIZE);
+	for (int i = 0; i < quantity; i += 8) {
+		__m256 moving = _mm256_castsi256_ps(_mm256_load_si256((__m256i*)(isMoving + i)));
+		__m256 oldPosX = _mm256_load_ps(posX + i);
+		__m256 oldPosZ = _mm256_load_ps(posZ + i);
+		__m256 newPosX = _mm256_add_ps(oldPosX, _mm256_mul_ps(_mm256_load_ps(speed + i), _mm256_load_ps(headingX + i)));
+		__m256 newPosZ = _mm256_add_ps(oldPosZ, _mm256_mul_ps(_mm256_load_ps(speed + i), _mm256_load_ps(headingZ + i)));
+		newPosX = _mm256_min_ps(_mm256_max_ps(newPosX, lowerBound), upperBound);
+		newPosZ = _mm256_min_ps(_mm256_max_ps(newPosZ, lowerBound), upperBound);
+		_mm256_store_ps(posX + i, _mm256_blendv_ps(oldPosX, newPosX, moving));
+		_mm256_store_ps(posZ + i, _mm256_blendv_ps(oldPosZ, newPosZ, moving));
+		_mm256_store_si256((__m256i*)(isMoving + i), _mm256_setzero_si256());
+	}
+#elif defined(HORSE_SIMD_SSE)
+	__m128 lowerBound = _mm_set1_ps(-FIELD_HALF_SIZE);
+	__m128 upperBound = _mm_set1_ps(FIELD_HALF_SIZE);
+	for (int i = 0; i < quantity; i += 4) {
+		__m128 moving = _mm_castsi128_ps(_mm_load_si128((__m128i*)(isMoving + i)));
+		__m128 oldPosX = _mm_load_ps(posX + i);
+		__m128 oldPosZ = _mm_load_ps(posZ + i);
+		__m128 newPosX = _mm_add_ps(oldPosX, _mm_mul_ps(_mm_load_ps(speed + i), _mm_load_ps(headingX + i)));
+		__m128 newPosZ = _mm_add_ps(oldPosZ, _mm_mul_ps(_mm_load_ps(speed + i), _mm_load_ps(headingZ + i)));
+		newPosX = _mm_min_ps(_mm_max_ps(newPosX, lowerBound), upperBound);
+		newPosZ = _mm_min_ps(_mm_max_ps(newPosZ, lowerBound), upperBound);
+		_mm_store_ps(posX + i, _mm_or_ps(_mm_and_ps(moving, newPosX), _mm_andnot_ps(moving, oldPosX)));
+		_mm_store_ps(posZ + i, _mm_or_ps(_mm_and_ps(moving, newPosZ), _mm_andnot_ps(moving, oldPosZ)));
+		_mm_store_si128((__m128i*)(isMoving + i), _mm_setzero_si128());
+	}
+#else
+	for (int i = 0; i < quantity; i++) {
+		if (isMoving[i]) {
+			posX[i] += speed[i] * headingX[i];
+			posZ[i] += speed[i] * headingZ[i];
+			if (posX[i] < -FIELD_HALF_SIZE)
+				posX[i] = -FIELD_HALF_SIZE;
+			else if (posX[i] > FIELD_HALF_SIZE)
+				posX[i] = FIELD_HALF_SIZE;
+			if (posZ[i] < -FIELD_HALF_SIZE)
+				posZ[i] = -FIELD_HALF_SIZE;
+			else if (posZ[i] > FIELD_HALF_SIZE)
+				posZ[i] = FIELD_HALF_SIZE;
+			isMoving[i] = 0;
+		}
+	}
+#endif
+}
+
+//Move every array to a bigger aligned allocation (indices stay the same so horses don't notice).
+void HorseHerd::grow(int capacityParam)
+{
+	posX = growArray(posX, capacityParam);
+	posZ = growArray(posZ, capacityParam);
+	pan = growArray(pan, capacityParam);
+	speed = growArray(speed, capacityParam);
+	collisionRadius = growArray(collisionRadius, capacityParam);
+	overallStatus = growArray(overallStatus, capacityParam);
+	headingX = growArray(headingX, capacityParam);
+	headingZ = growArray(headingZ, capacityParam);
+	forecastedPosX = growArray(forecastedPosX, capacityParam);
+	forecastedPosZ = growArray(forecastedPosZ, capacityParam);
+	isMoving = growArray(isMoving, capacityParam);
+	capacity = capacityParam;
+}
+
+//Slots past the last horse are zeroed so the kernels can read them safely.
+template <typename T> T* HorseHerd::growArray(T* oldArray, int capacityParam)
+{
+	T* newArray = (T*)_mm_malloc(capacityParam*sizeof(T), ALIGNMENT);
+	memset(newArray, 0, capacityParam*sizeof(T));
+	if (oldArray != NULL) {
+		memcpy(newArray, oldArray, quantity*sizeof(T));
+		_mm_free(oldArray);
+	}
+	return newArray;
+}
\ No newline at end of file
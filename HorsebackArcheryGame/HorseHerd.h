@@ -0,0 +1,64 @@
+#pragma once
+
+//Widest instruction set the heading kernel can use (defining HORSE_NO_SIMD forces the plain C++ version).
+#if !defined(HORSE_NO_SIMD) && defined(__AVX__)
+#define HORSE_SIMD_AVX
+#elif !defined(HORSE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HORSE_SIMD_SSE
+#endif
+
+enum status { normal, stopped, avoiding, controlled };
+
+//The state of every horse that is read or written every frame (movement and collision detection), stored field by field
+//in contiguous aligned arrays indexed by horse. Going through one field for the whole herd then only touches the cache
+//lines holding that field instead of pulling in every horse's matrices and body parts. Horses keep their index into the
+//herd and read/write their properties through it.
+class HorseHerd {
+	private:
+		static const int ALIGNMENT = 32;   //Arrays start on a boundary suitable for SSE/AVX loads.
+		const float PI = 3.14f;
+		const float FIELD_HALF_SIZE = 50.0f;  //Same bounds as Horse::checkBounds().
+
+		int quantity;
+		int capacity;
+
+		void grow(int capacityParam);
+		template <typename T> T* growArray(T* oldArray, int capacityParam);
+	public:
+		float* posX;
+		float* posZ;
+		float* pan;
+		float* speed;
+		float* collisionRadius;
+		status* overallStatus;
+
+		//Direction each horse faces (cos(pan + PI), -sin(pan + PI)) and where it will be next frame going straight.
+		//Refreshed for the whole herd once per frame by updateHeadings().
+		float* headingX;
+		float* headingZ;
+		float* forecastedPosX;
+		float* forecastedPosZ;
+
+		int* isMoving;                     //-1 if the horse goes straight this frame, 0 otherwise (see integrate()).
+
+		float worldRotation[16];           //Rotation of the whole field (column major), the same for every horse.
+
+		//Every random number a horse draws is keyed by these and the horse's id (see CounterRandom).
+		unsigned int randomSeed;
+		unsigned int tick;                 //Advanced once per simulation step.
+
+		HorseHerd();
+		int addHorse();
+		int getQuantity();
+		float getLargestCollisionRadius();
+
+		//Both give the exact same results (same polynomial, same order of operations), so a horse refreshing its own
+		//heading after turning agrees to the last bit with the herd-wide pass.
+		void updateHeadings();
+		void updateHeadings(int begin, int end);
+		void updateHeading(int i);
+		void getForecastedPosition(int i, float &forecastedPosXParam, float &forecastedPosZParam);
+
+		//Moves every horse flagged in isMoving by its speed along its heading and keeps it in bounds, then clears the flags.
+		void integrate();
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "HorseRenderer.h"
+#include "Profiler.h"
+
+//Attach per instance model matrices, normal matrices and colors to the cube VAO. Each body part of each horse is one instance.
+HorseRenderer::HorseRenderer(GLuint VAOParam, int drawTypeParam, GLStateCache* glStateParam)
+{
+	VAO = VAOParam;
+	drawType = drawTypeParam;
+	glState = glStateParam;
+	instanceQuantity = 0;
+
+	glGenBuffers(1, &modelMatrixVBO);
+	glGenBuffers(1, &normalMatrixVBO);
+	glGenBuffers(1, &colorVBO);
+	glBindVertexArray(VAO);
+
+	//A mat4 attribute is passed as four vec4 columns and a mat3 attribute as three columns.
+	for (GLuint i = 0; i < 4; i++) {
+		glEnableVertexAttribArray(MODEL_MATRIX_ATTRIBUTE + i);
+		glVertexAttribDivisor(MODEL_MATRIX_ATTRIBUTE + i, 1);
+	}
+	for (GLuint i = 0; i < 3; i++) {
+		glEnableVertexAttribArray(NORMAL_MATRIX_ATTRIBUTE + i);
+		glVertexAttribDivisor(NORMAL_MATRIX_ATTRIBUTE + i, 1);
+	}
+	glEnableVertexAttribArray(COLOR_ATTRIBUTE);
+	glVertexAttribDivisor(COLOR_ATTRIBUTE, 1);
+	pointAttributes(0);
+
+	glBindVertexArray(0);
+	glState->invalidate();
+}
+
+//Make the instance attributes start at firstInstance. GL 3.3 has no base instance for instanced draws, so a pass that
+//draws a range not starting at 0 moves the attribute pointers instead. The cube VAO has to be bound.
+void HorseRenderer::pointAttributes(int firstInstance)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, modelMatrixVBO);
+	for (GLuint i = 0; i < 4; i++)
+		glVertexAttribPointer(MODEL_MATRIX_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+			(GLvoid*)(firstInstance*sizeof(glm::mat4) + i*sizeof(glm::vec4)));
+
+	//The normal matrix columns are stored as vec4 (see NormalMatrix), only xyz is read.
+	glBindBuffer(GL_ARRAY_BUFFER, normalMatrixVBO);
+	for (GLuint i = 0; i < 3; i++)
+		glVertexAttribPointer(NORMAL_MATRIX_ATTRIBUTE + i, 3, GL_FLOAT, GL_FALSE, sizeof(NormalMatrix),
+			(GLvoid*)(firstInstance*sizeof(NormalMatrix) + i*sizeof(glm::vec4)));
+
+	glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+	glVertexAttribPointer(COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLvoid*)(firstInstance*sizeof(glm::vec4)));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	attributeFirstInstance = firstInstance;
+}
+
+//Copy the visible horses of this frame to the instance buffers. Done once per frame so both render passes share the
+//upload. The buffers are respecified every frame so the driver doesn't have to wait on draws still reading last frame's data.
+void HorseRenderer::upload(HorseCuller* culler)
+{
+	PROFILE_ZONE("Upload instances");
+
+	instanceQuantity = culler->getInstanceQuantity();
+
+	glBindBuffer(GL_ARRAY_BUFFER, modelMatrixVBO);
+	glBufferData(GL_ARRAY_BUFFER, instanceQuantity*sizeof(glm::mat4), culler->getModelMatrices(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, normalMatrixVBO);
+	glBufferData(GL_ARRAY_BUFFER, instanceQuantity*sizeof(NormalMatrix), culler->getNormalMatrices(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+	glBufferData(GL_ARRAY_BUFFER, instanceQuantity*sizeof(glm::vec4), culler->getColors(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//Draw the body parts from firstInstance on in one call. instancedLocation is the "instanced" uniform of the program in
+//use. It is turned off again afterwards so other objects keep using the model matrix and color uniforms. The VAO is
+//left bound, the state cache knows it is and the next draw binds its own.
+void HorseRenderer::draw(GLint instancedLocation, int firstInstance, int quantity)
+{
+	if (quantity == 0)
+		return;
+
+	glState->setUniform(instancedLocation, GL_TRUE);
+	glState->bindVertexArray(VAO);
+	if (firstInstance != attributeFirstInstance)
+		pointAttributes(firstInstance);
+	glDrawArraysInstanced(drawType, 0, 36, quantity);
+	glState->setUniform(instancedLocation, GL_FALSE);
+}
+
+//Set how the horse is rendered.
+void HorseRenderer::setDrawType(int drawTypeParam) {
+	drawType = drawTypeParam;
+}
\ No newline at end of file
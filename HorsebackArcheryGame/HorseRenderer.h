@@ -0,0 +1,29 @@
+#pragma once
+
+#include "..\glew\glew.h"	//include GL Extension Wrangler
+#include "..\glfw\glfw3.h"	//include GLFW helper library
+
+#include "HorseCuller.h"
+#include "GLStateCache.h"
+
+class HorseRenderer {
+	private:
+		static const GLuint MODEL_MATRIX_ATTRIBUTE = 3; //First of the four locations holding the columns of the instance model matrix.
+		static const GLuint COLOR_ATTRIBUTE = 7;
+		static const GLuint NORMAL_MATRIX_ATTRIBUTE = 8; //First of the three locations holding the columns of the instance normal matrix.
+		GLuint VAO;
+		GLuint modelMatrixVBO;
+		GLuint normalMatrixVBO;
+		GLuint colorVBO;
+		int instanceQuantity;
+		int attributeFirstInstance;  //Instance the attribute pointers start at.
+		int drawType;
+		GLStateCache* glState;
+
+		void pointAttributes(int firstInstance);
+	public:
+		HorseRenderer(GLuint VAOParam, int drawTypeParam, GLStateCache* glStateParam);
+		void upload(HorseCuller* culler);
+		void draw(GLint instancedLocation, int firstInstance, int quantity);
+		void setDrawType(int drawTypeParam);
+};
\ No newline at end of file
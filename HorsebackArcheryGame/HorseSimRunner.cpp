@@ -0,0 +1,125 @@
+/***************************************************************************************************\
+| Program:     Horse Simulation Runner                                                              |
+| Description: Steps the horse herd without a window or an OpenGL context and reports how many      |
+|              simulation frames were computed per second. Useful for profiling the simulation and  |
+|              for stepping it far faster than real time.                                           |
+| Usage:       HorseSimRunner [--horses N] [--seed S] [--frames F] [--threads C] [--poses]          |
+|                              [--trace T]                                                          |
+|              - N: amount of horses to generate (default 20).                                      |
+|              - S: seed for the random number generator (default 1).                               |
+|              - F: amount of frames to simulate (default 1000).                                    |
+|              - C: amount of threads to use, 1 runs everything on the main thread (default:        |
+|                one per hardware thread). The result is the same for any amount of threads.        |
+|              - --poses: also compute the pose of every horse every frame like the game does.      |
+|              - T: write a Chrome trace of every frame to this file (zones are only recorded when  |
+|                built with HORSE_PROFILE, which only the Debug configuration defines).             |
+| Building:    Part of the Visual Studio solution. On other platforms compile this file together    |
+|              with the sources listed in HorseSimulation.vcxproj and put ../glm and .. on the      |
+|              include path, e.g. on Linux:                                                         |
+|              g++ -O2 -std=c++11 -pthread -I../glm -I.. HorseSimRunner.cpp <sources>               |
+\***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>           //For timing the simulation.
+#include <algorithm>        //For max() function.
+
+#include "Simulation.h"
+#include "PoseEvaluator.h"
+#include "Profiler.h"
+
+void printUsage();
+
+int main(int argc, char* argv[])
+{
+	int horseQuantity = 20;
+	unsigned int seed = 1;
+	int frames = 1000;
+	bool evaluatePoses = false;
+	const char* tracePath = NULL;
+	int threadQuantity = JobSystem::getDefaultWorkerQuantity() + 1;
+
+	//Read the command line options (each one is followed by its value).
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && strcmp(argv[i], "--horses") == 0)
+			horseQuantity = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+			seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0)
+			frames = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0)
+			threadQuantity = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--poses") == 0)
+			evaluatePoses = true;
+		else if (i + 1 < argc && strcmp(argv[i], "--trace") == 0)
+			tracePath = argv[++i];
+		else {
+			printUsage();
+			return -1;
+		}
+	}
+	if (horseQuantity < 1 || frames < 1 || threadQuantity < 1) {
+		printUsage();
+		return -1;
+	}
+
+	JobSystem jobs(threadQuantity - 1);
+	Simulation simulation(seed);
+	simulation.setJobSystem(&jobs);
+	simulation.spawnHorses(horseQuantity);
+	if (simulation.getOverlappingSpawnQuantity() > 0)
+		printf("%d of %d horses didn't fit on the field and overlap other horses (%.0f%% of the field in collision circles, horses placed one at a time jam at about 55%%).\n",
+			simulation.getOverlappingSpawnQuantity(), horseQuantity, simulation.getSpawnCoveredFraction() * 100.0);
+
+	//Only the stepping itself is timed (spawning is a one time cost).
+	PoseEvaluator poseEvaluator;
+	poseEvaluator.setJobSystem(&jobs);
+	long long evaluatedPoses = 0;
+	long long evaluatedBodyParts = 0;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	Profiler* profiler = Profiler::getInstance();
+	for (int i = 0; i < frames; i++) {
+		profiler->markFrame();
+		simulation.step();
+		if (evaluatePoses) {
+			poseEvaluator.recordTick(&simulation);
+			poseEvaluator.evaluate(&simulation, 1.0f);
+			evaluatedPoses += poseEvaluator.getEvaluatedQuantity();
+			evaluatedBodyParts += poseEvaluator.getEvaluatedBodyPartQuantity();
+		}
+	}
+	profiler->markFrame();
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+
+	double seconds = chrono::duration<double>(end - start).count();
+	printf("Simulated %d frames of %d horses (seed %u, %d threads) in %.3f seconds.\n", frames, horseQuantity, seed, threadQuantity, seconds);
+	if (seconds > 0.0)
+		printf("%.1f simulation frames per second (%.4f ms per frame).\n", frames / seconds, seconds * 1000.0 / frames);
+	printf("Neighbour lists were built %d times (every %.1f frames).\n", simulation.getNeighbourListRebuildQuantity(),
+		(double)frames / max(1, simulation.getNeighbourListRebuildQuantity()));
+	if (evaluatePoses) {
+		printf("%.1f%% of the poses had to be computed (the rest didn't change since the frame before).\n", 100.0 * evaluatedPoses / ((double)frames * horseQuantity));
+		printf("%.1f%% of the body part matrices had to be computed.\n", 100.0 * evaluatedBodyParts / ((double)frames * horseQuantity * bodyPartQuantity));
+	}
+
+	RollingStatistics* frameTimes = profiler->getFrameTimes();
+	printf("Frame time over the last %d frames: p50 %.4f ms, p95 %.4f ms, p99 %.4f ms.\n", frameTimes->getSampleQuantity(),
+		frameTimes->getPercentile(50), frameTimes->getPercentile(95), frameTimes->getPercentile(99));
+	if (tracePath != NULL) {
+		if (!profiler->writeChromeTrace(tracePath)) {
+			printf("Failed to write %s\n", tracePath);
+			return -1;
+		}
+		printf("Wrote %d events to %s (%d dropped).\n", profiler->getEventQuantity(), tracePath, profiler->getDroppedEventQuantity());
+#ifndef HORSE_PROFILE
+		printf("Only frames are in the trace: CPU zones are compiled out without HORSE_PROFILE.\n");
+#endif
+	}
+	return 0;
+}
+
+void printUsage()
+{
+	printf("Usage: HorseSimRunner [--horses N] [--seed S] [--frames F] [--threads C] [--poses] [--trace T]\n");
+}
\ No newline at end of file
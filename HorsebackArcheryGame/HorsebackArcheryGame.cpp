@@ -26,6 +26,8 @@
 |              - Panning, tilting and zooming of camera.                                            |
 |              - When window is resized, the proportions remain proper while maintaining the        |
 |                central position of the camera.                                                    |
+|              - Pressing F prints frame time percentiles and GPU pass times to the console and     |
+|                writes a Chrome trace of the session to profile.json.                              |
 \***************************************************************************************************/
 
 #include "stdafx.h"
@@ -36,7 +38,6 @@
 #include <iostream>
 #include <string>
 #include <fstream>
-#include <random>           //For rand() function.
 #include <time.h>           //For time() function.
 #include <vector>           //For a list based data structure with dynamic sizing.
 #include <math.h>           //For sqrt() function.
@@ -46,8 +47,18 @@
 #include "gtc/matrix_transform.hpp"
 #include "gtc/type_ptr.hpp"
 
-//Include the class that represents a horse (this class contains the stack, node and tree data structures).
-#include "Horse.h"
+//Include the simulation that owns every horse (horses contain the node and tree data structures) and the renderer that draws them.
+#include "Simulation.h"
+#include "TaskGraph.h"
+#include "HorseRenderer.h"
+#include "GLStateCache.h"
+#include "FrameUniformBuffer.h"
+#include "ShadowMap.h"
+#include "SimdMatrix.h"     //For composing the camera's matrices on SSE types.
+
+//Frame time statistics, CPU zones and GPU pass timings.
+#include "Profiler.h"
+#include "GpuTimer.h"
 
 //For image loading.
 #define STB_IMAGE_IMPLEMENTATION
@@ -74,6 +85,11 @@ glm::vec4 WHITE = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
 int HORSES = 20;        //Amount of horses to generate in the scene.
 
+//The simulation advances in ticks of a fixed length, however long rendering a frame takes (horse speeds, turns and
+//animations are all amounts per tick). Rendering interpolates between the last two ticks.
+const double TICK_SECONDS = 1.0 / 60.0;
+const double MAX_FRAME_SECONDS = 0.25;  //Longer frames (e.g. dragging the window) only advance the simulation this much.
+
 //Indication of whether various mouse buttons are being held or not.
 bool leftMouseHold = false;
 bool middleMouseHold = false;
@@ -127,11 +143,20 @@ bool animationActive = false;              //Indicate whether to keep the scene
 bool selectingHorse = false;               //Indicate whether the user is currently selecting a horse.
 bool controllingHorse = false;             //Indicate whether the user is controlling a horse.
 
-vector<Horse*> horses;                     //All horses that exist in the scene.
+JobSystem* jobSystem;                      //Worker threads for the per-horse work (GL calls stay on the main thread).
+Simulation* simulation;                    //All horses that exist in the scene and how they behave.
+PoseEvaluator* poseEvaluator;              //What every horse's body parts are drawn with this frame.
+HorseCuller* horseCuller;                  //Which horses the camera and the light can see this frame.
+HorseRenderer* horseRenderer;              //Draws every horse.
+GLStateCache* glState;                     //Program, VAO, texture and uniform state of the render loop (skips calls that change nothing).
+FrameUniformBuffer* frameUniforms;         //Camera, light and shadow values shared by both shader programs.
+ShadowMap* shadowMap;                      //Depth of the scene seen from the light, kept while nothing in it changes.
+GpuTimer* shadowPassTimer;                 //GPU time of the shadow map pass.
+GpuTimer* mainPassTimer;                   //GPU time of the pass drawn to the window.
 int selectedHorse = 1;
 
 GLuint gridVAO, gridVBO, cubeVAO, cubeVBO;
-GLuint transformLoc, viewMatrixLoc, projectionLoc, shadowTransformLoc, shadowViewMatrixLoc1, shadowViewMatrixLoc2, shadowProjectionLoc1, shadowProjectionLoc2, shadowsActiveLoc, objectColorLocation;
+GLuint transformLoc, normalMatrixLoc, shadowTransformLoc, shadowsActiveLoc, objectColorLocation, instancedLoc, shadowInstancedLoc;
 unsigned int plainTexture, grassTexture, horseSkinTexture;
 glm::mat4 worldRotation;
 glm::mat4 model_matrix;
@@ -149,16 +174,9 @@ void window_size_callback(GLFWwindow* window, int newWidth, int newHeight);
 GLuint importShaders(string vertex_shader_path, string fragment_shader_path);
 unsigned int importTexture(char const *file_path);
 
-float distanceBetweenTwoPoints(float x1, float x2, float y1, float y2, float z1, float z2);
-bool sphereCollisionDetection(glm::vec3 pos1, glm::vec3 pos2, float radius1, float radius2);
-bool collisionDetected(Horse* horse1, Horse* horse2, forecastDirection direction);
-bool collisionDetectedWithControlledHorse(Horse* controlledHorse, Horse* independentHorse);
-bool isFartherFromCollision(Horse* stoppedHorse, Horse* avoidingHorse, forecastDirection direction);
-void collisionResolutionDuring(Horse* horse1, Horse* horse2);
-void collisionResolutionEnd(Horse* horse1, Horse* horse2);
-
-void generateGrid(GLuint shaderProgram);
-int randomNumber(int min, int max);
+void renderFrame(GLuint shaderProgram, GLuint shadowShaderProgram, int width, int height, GLuint regularTextureLoc, GLuint shadowMapLoc);
+void generateGrid(GLuint shaderProgram, GLint modelMatrixLocation, GLint normalMatrixLocation, GLint colorLocation);
+void printProfile();
 
 //The MAIN function, from here we start the application and run the game loop
 int main()
@@ -214,11 +232,12 @@ int main()
 	glUseProgram(shaderProgram);
 
 	objectColorLocation = glGetUniformLocation(shaderProgram, "objectColor");         //Allow the color of an object to be changed.
-	int lightColorLocation = glGetUniformLocation(shaderProgram, "lightColor");       //Allow the light color to be changed.
-	int lightPositionLocation = glGetUniformLocation(shaderProgram, "lightPosition"); //Allow modification of variable influencing how bright a face of a
-	//shape is when it's within/away from the light.
-	int viewPositionLocation = glGetUniformLocation(shaderProgram, "viewPosition");   //Allow modification of temporary camera position of variable to
-	//influence specular lighting.
+
+	//Light color and position, the camera position used for specular lighting and the camera and shadow matrices are
+	//set once per frame for both programs through a uniform buffer.
+	frameUniforms = new FrameUniformBuffer();
+	frameUniforms->attach(shaderProgram);
+	frameUniforms->attach(shadowShaderProgram);
 
 	//GRID PROPERTIES
 	//Where vertices for the grid are defined (first 3: position, middle 2: texture, last 3: normals).
@@ -317,179 +336,99 @@ int main()
 	grassTexture = importTexture("grass.jpg");
 
 	//Use texture for the shadow map (the frame buffer is important for applying the shadow map before drawing the scene itself).
-	unsigned int shadowMapFBO;
-	glGenFramebuffers(1, &shadowMapFBO);
-	unsigned int shadowMap;
-	glGenTextures(1, &shadowMap);
-	glBindTexture(GL_TEXTURE_2D, shadowMap);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMap, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	shadowMap = new ShadowMap(SHADOW_WIDTH, SHADOW_HEIGHT);
 
 	//ID's for both textures (important since shadow map shouldn't depend on the object's current texture).
 	unsigned int regularTextureLoc = glGetUniformLocation(shaderProgram, "textureContent");
 	unsigned int shadowMapLoc = glGetUniformLocation(shaderProgram, "shadowMap");
 
-	//Initialize matrices required for camera and shadow map that reside in the shader program.
+	//Model matrices of objects that aren't instanced (the other matrices are in the frame uniform buffer).
 	transformLoc = glGetUniformLocation(shaderProgram, "model_matrix");
-	viewMatrixLoc = glGetUniformLocation(shaderProgram, "view_matrix");
-	projectionLoc = glGetUniformLocation(shaderProgram, "projection_matrix");
-	shadowViewMatrixLoc1 = glGetUniformLocation(shaderProgram, "shadow_view_matrix");
-	shadowProjectionLoc1 = glGetUniformLocation(shaderProgram, "shadow_projection_matrix");
-
-	//Initialize matrices required for light POV in shader for the shadow map.
-	shadowViewMatrixLoc2 = glGetUniformLocation(shadowShaderProgram, "shadow_view_matrix");
-	shadowProjectionLoc2 = glGetUniformLocation(shadowShaderProgram, "shadow_projection_matrix");
+	normalMatrixLoc = glGetUniformLocation(shaderProgram, "normal_matrix");
+	shadowTransformLoc = glGetUniformLocation(shadowShaderProgram, "shadow_model_matrix");
 
 	shadowsActiveLoc = glGetUniformLocation(shaderProgram, "shadowsActive");  //Initialize boolean that determines whether to apply shadows or not.
 
-	srand(time(NULL)); //Prevent RNG from generating the same list of numbers each time the program is loaded.
-
-	//Generate all horses in random positions without causing collisions from the start.
-	for (int i = 0; i < HORSES; i++) {
-		horses.push_back(new Horse(objectColorLocation, transformLoc, cubeVAO, drawType, i + 1));
-		for (int j = 0; j < horses.size() - 1; j++) {
-			if (collisionDetected(horses.at(j), horses.at(i), noDir)) {
-				horses.at(i)->randomizePosition();
-				j = -1;                               //Need to cycle through all horses again if a collision is found!
-			}
-		}
-	}
+	//Booleans that switch both shader programs to per instance model matrices and colors when drawing horses.
+	instancedLoc = glGetUniformLocation(shaderProgram, "instanced");
+	shadowInstancedLoc = glGetUniformLocation(shadowShaderProgram, "instanced");
+
+	simulation = new Simulation(time(NULL)); //Prevent RNG from generating the same list of numbers each time the program is loaded.
+	simulation->spawnHorses(HORSES);         //Generate all horses in random positions without causing collisions from the start.
+	if (simulation->getOverlappingSpawnQuantity() > 0)
+		std::cout << simulation->getOverlappingSpawnQuantity() << " of " << HORSES << " horses didn't fit on the field and overlap other horses ("
+			<< (int)(simulation->getSpawnCoveredFraction() * 100) << "% of the field in collision circles, horses placed one at a time jam at about 55%)." << std::endl;
+	poseEvaluator = new PoseEvaluator();
+	horseCuller = new HorseCuller();
+	jobSystem = new JobSystem(JobSystem::getDefaultWorkerQuantity());
+	simulation->setJobSystem(jobSystem);
+	poseEvaluator->setJobSystem(jobSystem);
+	poseEvaluator->recordTick(simulation);   //Nothing to interpolate from before the first tick.
+	glState = new GLStateCache();
+	horseRenderer = new HorseRenderer(cubeVAO, drawType, glState);
+	shadowPassTimer = new GpuTimer("Shadow pass");
+	mainPassTimer = new GpuTimer("Main pass");
 
 	worldRotation = glm::rotate(model_matrix, worldPan, glm::vec3(0.0f, 1.0f, 0.0f)) //Applied to grid and horse for world rotation.
 		*glm::rotate(model_matrix, worldTilt, glm::vec3(1.0f, 0.0f, 0.0f));
 
+	double previousTime = glfwGetTime();
+	double tickAccumulator = 0.0;            //Time that has passed but hasn't been simulated yet.
+
+	//Every frame runs as a graph of its phases. The ticks and the pose evaluation spread their per-horse work over the job
+	//system themselves, and the render task is pinned since only this thread has the GL context.
+	TaskGraph frameGraph;
+	int tickTask = frameGraph.addTask("Simulation ticks", [&tickAccumulator] {
+		//Run as many ticks as fit in the time that passed (none on some frames when rendering is faster than the tick rate).
+		while (tickAccumulator >= TICK_SECONDS) {
+			//Collision detection and resolution. Accounts for entry of collision, during the collision and once the collision ends.
+			simulation->resolveCollisions();
+
+			//Updates position and animation of horse. Only accessed when animations are on.
+			if (animationActive)
+				simulation->updatePositions();
+
+			poseEvaluator->recordTick(simulation);
+			tickAccumulator -= TICK_SECONDS;
+		}
+	}, false);
+	int poseTask = frameGraph.addTask("Pose evaluation", [&tickAccumulator] {
+		//Compute the pose of every horse once, part way between the last two ticks. Both render passes only read it.
+		poseEvaluator->evaluate(simulation, (float)(tickAccumulator / TICK_SECONDS));
+	}, false);
+	int renderTask = frameGraph.addTask("Render", [&] {
+		renderFrame(shaderProgram, shadowShaderProgram, width, height, regularTextureLoc, shadowMapLoc);
+	}, true);
+	frameGraph.addDependency(tickTask, poseTask);
+	frameGraph.addDependency(poseTask, renderTask);
+
 	// Game loop
 	while (!glfwWindowShouldClose(window))
 	{
-		//Check if any events have been activiated (key pressed, mouse lmoved etc.) and call corresponding response functions
-		glfwPollEvents();
-
-		//Render
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);               //Clear the colorbuffer (i.e. set background color)
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //Clear color bit to update colors of all objects and clear depth bit to update depth bit of all objects.
-
-		model_matrix = glm::scale(model_matrix, glm::vec3(1.0f)); //Set a basis for coordinate measurements.
-
-		//FOR SHADOW SHADER
-		glm::mat4 shadow_view_matrix = glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
-		glm::mat4 shadow_projection_matrix = glm::perspective(PI / 2, (GLfloat)SHADOW_WIDTH / (GLfloat)SHADOW_HEIGHT, 1.0f, 25.0f);
-		//glm::mat4 shadow_projection_matrix = glm::ortho(-50.0f, 50.0f, -20.0f, 20.0f, -50.0f, 50.0f);
-
-		glUseProgram(shadowShaderProgram);
-		glUniformMatrix4fv(shadowTransformLoc, 1, GL_FALSE, glm::value_ptr(model_matrix));
-		glUniformMatrix4fv(shadowViewMatrixLoc2, 1, GL_FALSE, glm::value_ptr(shadow_view_matrix));
-		glUniformMatrix4fv(shadowProjectionLoc2, 1, GL_FALSE, glm::value_ptr(shadow_projection_matrix));
-
-		//Have the shadow map gather the proper depth values needed.
-		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-		glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-		glClear(GL_DEPTH_BUFFER_BIT);
-		for (int i = 0; i < HORSES; i++)
-			horses.at(i)->draw();
-		generateGrid(shadowShaderProgram);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		//Reset to window proportions (shadow map uses different proportions).
-		glViewport(0, 0, WIDTH, HEIGHT);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		//Vectors used for the view matrix. Ensure that viewUp is the proper vector direction relative to viewPos. Keep viewCenter at the origin.
-		glm::vec3 viewPos = glm::vec3(0.0f, 20.0f, 0.0f);
-		glm::vec3 viewCenter = glm::vec3(0.0f, 0.0f, 0.0f);
-		glm::vec3 viewUp = glm::vec3(0.0f, 0.0f, -1.0f);
-
-		//Modify temporary variables used to influence the shiny part of the light.
-		//Uses spherical coordinates to get x, y and z variables due to movements being rotation based.
-		//x = distance*cos(theta)*sin(phi)
-		//y = distance*cos(phi)             (traditionally for z-axis but y-axis is considered up axis in this context).
-		//z = distance*sin(theta)*sin(phi)  (negated below due to program reversing the orientation of z-axis in comparison to natural world orientation).
-		tempViewPosX = 20.0f*cos(theta)*sin(phi);
-		tempViewPosY = 20.0f*cos(phi);
-		tempViewPosZ = -20.0f*sin(theta)*sin(phi);
-
-		glm::mat4 view_matrix;                                    //Dictates a camera's position and where the camera is facing.
-		view_matrix = glm::lookAt(viewPos, viewCenter, viewUp)
-			*glm::translate(model_matrix, viewUp)
-			*glm::translate(model_matrix, (glm::cross(glm::normalize(viewPos), glm::normalize(viewUp)))
-			*(translateX))
-			*glm::rotate(model_matrix, cameraTilt, glm::normalize(glm::cross(viewUp, viewPos)))
-			*glm::rotate(model_matrix, cameraPan, glm::vec3(0.0f, 1.0f, 0.0f));
-
-		glm::mat4 projection_matrix;                              //Dictate's a camera's zoom and it's near and far planes.
-		projection_matrix = glm::perspective(zoomValue, (GLfloat)width / (GLfloat)height, 0.1f, 100.0f)*
-			glm::scale(model_matrix, glm::vec3(windowAdjustmentX, windowAdjustmentY, 1.0f)); //Let's camera be adaptable to current window size (near plane is 0.1f since z-buffering
-		//doesn't like near plane at 0.0f)
-
-		//Let the program make use of model, view and projection matrices (for the camera to get the proper view and the light to get the proper shadows).
-		glUseProgram(shaderProgram);
-		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(model_matrix));
-		glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, glm::value_ptr(view_matrix));
-		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection_matrix));
-		glUniformMatrix4fv(shadowViewMatrixLoc1, 1, GL_FALSE, glm::value_ptr(shadow_view_matrix));
-		glUniformMatrix4fv(shadowProjectionLoc1, 1, GL_FALSE, glm::value_ptr(shadow_projection_matrix));
-		glUniform1i(regularTextureLoc, 0);
-		glUniform1i(shadowMapLoc, 1);
-
-		glUniform4f(lightColorLocation, 1.0f, 1.0f, 1.0f, 1.0f);                      //Set light color (currently white).
-		glUniform3f(lightPositionLocation, 0.0f, 20.0f, 0.0f);                        //Set light position (currently 20 units above initial horse position).
-		glUniform3f(viewPositionLocation, tempViewPosX, tempViewPosY, tempViewPosZ);  //Use temporary camera position variables to influence specular lighting.
-		glUniform1i(shadowsActiveLoc, shadowsActive);                                 //Indicate to shader whether to apply shadows or not.
-
-		glActiveTexture(GL_TEXTURE1);                                                 //Bind shadow map to proper texture ID.
-		glBindTexture(GL_TEXTURE_2D, shadowMap);
-		glActiveTexture(GL_TEXTURE0);                                                 //Allow actual textures to be binded to proper texture ID.
-		if (texturesActive)                                                           //Use horse skin texture if textures are active. Otherwise, use plain texture.
-			glBindTexture(GL_TEXTURE_2D, horseSkinTexture);
-		else
-			glBindTexture(GL_TEXTURE_2D, plainTexture);
-		for (int i = 0; i < HORSES; i++)
-			horses.at(i)->draw();                                                     //Render horse.
-		glActiveTexture(GL_TEXTURE0);
-		if (texturesActive)                                                           //Use grass texture if textures are active. Otherwise, use plain texture.
-			glBindTexture(GL_TEXTURE_2D, grassTexture);
-		else
-			glBindTexture(GL_TEXTURE_2D, plainTexture);
-		generateGrid(shaderProgram);                                                  //Render floor.
-
-		//Collision detection loop. Accounts for entry of collision, during the collision and once the collision ends.
-		for (int i = 0; i < HORSES - 1; i++)
-			for (int j = i + 1; j < HORSES; j++) {
-				if (collisionDetected(horses.at(i), horses.at(j), straightDir))
-					collisionResolutionDuring(horses.at(i), horses.at(j));
-				else
-					collisionResolutionEnd(horses.at(i), horses.at(j));
-			}
+		Profiler::getInstance()->markFrame();
+		glState->markFrame();
 
-		//Reset various properties to allow collision detection to resume as normal next frame.
-		for (int i = 0; i < HORSES - 1; i++) {
-			//If two horses collided with each other and are in a stopped state, allow one of them to avoid so they aren't permanently stuck.
-			if (horses.at(i)->getCollisionStatus() != normal && horses.at(i)->doCollisionsExist()) {
-				Horse* currentHorse = horses.at(i);
-				Horse* otherHorse = horses.at(horses.at(i)->getCurrentCollision() - 1);
-				if (horses.at(i)->getCollisionStatus() == stopped && otherHorse->getCollisionStatus() == stopped) {
-					randomNumber(0, 1) == 0 ? currentHorse->setCollisionStatus(avoiding) : otherHorse->setCollisionStatus(avoiding);
-				}
-			}
-			if (horses.at(i)->getDirectionAssigned() == true) //Ensure that an avoiding horse is not stuck with left or right in subsequent
-				horses.at(i)->setDirectionAssigned(false);    //collision checks.
+		//Check if any events have been activiated (key pressed, mouse lmoved etc.) and call corresponding response functions
+		{
+			PROFILE_ZONE("Poll events");
+			glfwPollEvents();
 		}
 
-		//Updates position and animation of horse. Only accessed when animations are on.
-		if (animationActive)
-			for (int i = 0; i < HORSES; i++)
-				horses.at(i)->updatePosition();
+		double currentTime = glfwGetTime();
+		double frameSeconds = currentTime - previousTime;
+		if (frameSeconds > MAX_FRAME_SECONDS)
+			frameSeconds = MAX_FRAME_SECONDS;
+		tickAccumulator += frameSeconds;
+		previousTime = currentTime;
+
+		//Simulation ticks, then the poses, then the GL calls (see frameGraph).
+		frameGraph.run(jobSystem);
 
 		// Swap the screen buffers
-		glfwSwapBuffers(window);
+		{
+			PROFILE_ZONE("Swap buffers");
+			glfwSwapBuffers(window);
+		}
 	}
 
 	// Terminate GLFW, clearing any resources allocated by GLFW.
@@ -507,24 +446,24 @@ void character_callback(GLFWwindow* window, unsigned int codepoint)
 		//Uses ASCII Notation - 65/97: A/a, 68/100: D/d, 87/119: W/w, 32: Space.
 		if (codepoint == 65 || codepoint == 97) {        //Rotate horse left.
 			if (controllingHorse) {
-				horses.at(selectedHorse - 1)->move(leftDir);
+				simulation->getHorse(selectedHorse - 1)->move(leftDir);
 			}
 		}
 		if (codepoint == 68 || codepoint == 100) {       //Rotate horse right.
 			if (controllingHorse) {
-				horses.at(selectedHorse - 1)->move(rightDir);
+				simulation->getHorse(selectedHorse - 1)->move(rightDir);
 			}
 		}
 		if (codepoint == 87 || codepoint == 119) {       //Move horse straight (if it doesn't result in a collision).
 			for (int i = 0; i < HORSES; i++)
 			{
-				if (horses.at(selectedHorse - 1)->getId() != horses.at(i)->getId())
-					if (collisionDetectedWithControlledHorse(horses.at(selectedHorse - 1), horses.at(i))) {
+				if (simulation->getHorse(selectedHorse - 1)->getId() != simulation->getHorse(i)->getId())
+					if (simulation->collisionDetectedWithControlledHorse(simulation->getHorse(selectedHorse - 1), simulation->getHorse(i))) {
 						break;
 					}
 
 				if (i == HORSES - 1)
-					horses.at(selectedHorse - 1)->move(straightDir);
+					simulation->getHorse(selectedHorse - 1)->move(straightDir);
 			}
 		}
 
@@ -532,12 +471,12 @@ void character_callback(GLFWwindow* window, unsigned int codepoint)
 		//Uses ASCII Notation - 85/117: U/u, 74/106: J/j.
 		if (codepoint == 85 || codepoint == 117) {  //Increase speed
 			if (controllingHorse) {
-				horses.at(selectedHorse - 1)->incrementSpeed();
+				simulation->getHorse(selectedHorse - 1)->incrementSpeed();
 			}
 		}
 		if (codepoint == 74 || codepoint == 106) {  //Decrease speed
 			if (controllingHorse) {
-				horses.at(selectedHorse - 1)->decrementSpeed();
+				simulation->getHorse(selectedHorse - 1)->decrementSpeed();
 			}
 		}
 	}
@@ -613,20 +552,24 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 			shadowsActive = true;
 	}
 
+	//Print frame time statistics and write the trace of the session.
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		printProfile();
+
 	//Toggle whether to debug collisions or not.
 	if (key == GLFW_KEY_M && action == GLFW_PRESS) {
 		if (debugCollisions) {
 			debugCollisions = false;
 			for (int i = 0; i < HORSES; i++) {
-				horses.at(i)->setDebugCollisionStatus(false);
-				horses.at(i)->updateDebugColors();
+				simulation->getHorse(i)->setDebugCollisionStatus(false);
+				simulation->getHorse(i)->updateDebugColors();
 			}
 		}
 		else {
 			debugCollisions = true;
 			for (int i = 0; i < HORSES; i++) {
-				horses.at(i)->setDebugCollisionStatus(true);
-				horses.at(i)->updateDebugColors();
+				simulation->getHorse(i)->setDebugCollisionStatus(true);
+				simulation->getHorse(i)->updateDebugColors();
 			}
 		}
 	}
@@ -642,43 +585,43 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	//Allow user to cycle leftwards through horses when selecting a horse.
 	if (key == GLFW_KEY_A && action == GLFW_PRESS) {
 		if (selectingHorse) {
-			horses.at(selectedHorse - 1)->setIsSelected(false);
+			simulation->getHorse(selectedHorse - 1)->setIsSelected(false);
 			selectedHorse--;
 			if (selectedHorse < 1)
 				selectedHorse = HORSES;
-			horses.at(selectedHorse - 1)->setIsSelected(true);
+			simulation->getHorse(selectedHorse - 1)->setIsSelected(true);
 		}
 	}
 
 	//Allow user to cycle rightwards through horses when selecting a horse.
 	if (key == GLFW_KEY_D && action == GLFW_PRESS) {
 		if (selectingHorse) {
-			horses.at(selectedHorse - 1)->setIsSelected(false);
+			simulation->getHorse(selectedHorse - 1)->setIsSelected(false);
 			selectedHorse++;
 			if (selectedHorse > HORSES)
 				selectedHorse = 1;
-			horses.at(selectedHorse - 1)->setIsSelected(true);
+			simulation->getHorse(selectedHorse - 1)->setIsSelected(true);
 		}
 	}
 
 	//Allow user to select a horse/give up control of a horse.
 	if (key == GLFW_KEY_ENTER && action == GLFW_PRESS){
 		if (selectingHorse) {
-			horses.at(selectedHorse - 1)->setIsControlled(true);
-			horses.at(selectedHorse - 1)->setIsSelected(false);
+			simulation->getHorse(selectedHorse - 1)->setIsControlled(true);
+			simulation->getHorse(selectedHorse - 1)->setIsSelected(false);
 			controllingHorse = true;
 			selectingHorse = false;
 		}
 		else if (controllingHorse) {
-			horses.at(selectedHorse - 1)->setIsControlled(false);
+			simulation->getHorse(selectedHorse - 1)->setIsControlled(false);
 			controllingHorse = false;
 		}
 	}
 
 	//Allow user to stop a horse (the horse jumps when stopped)
 	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && animationActive) {
-		if (controllingHorse && !horses.at(selectedHorse - 1)->getIsHorseStopped()) {
-			horses.at(selectedHorse - 1)->stopHorse();
+		if (controllingHorse && !simulation->getHorse(selectedHorse - 1)->getIsHorseStopped()) {
+			simulation->getHorse(selectedHorse - 1)->stopHorse();
 		}
 	}
 
@@ -687,11 +630,11 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	{
 		if (!controllingHorse) {
 			if (action == GLFW_PRESS) {
-				horses.at(selectedHorse - 1)->setIsSelected(true);
+				simulation->getHorse(selectedHorse - 1)->setIsSelected(true);
 				selectingHorse = true;
 			}
 			if (action == GLFW_RELEASE) {
-				horses.at(selectedHorse - 1)->setIsSelected(false);
+				simulation->getHorse(selectedHorse - 1)->setIsSelected(false);
 				selectingHorse = false;
 			}
 		}
@@ -777,8 +720,7 @@ void window_size_callback(GLFWwindow* window, int newWidth, int newHeight)
 //Called so that each horse is rendered the specified way when the user changes the rendering type.
 void updateDrawType()
 {
-	for (int i = 0; i < HORSES; i++)
-		horses.at(i)->setDrawType(drawType);
+	horseRenderer->setDrawType(drawType);
 }
 
 //Update world orientation for both grid and all horses.
@@ -786,9 +728,7 @@ void updateWorldOrientation()
 {
 	worldRotation = glm::rotate(model_matrix, worldPan, glm::vec3(0.0f, 1.0f, 0.0f)) //Applied to grid and horse for world rotation.
 		* glm::rotate(model_matrix, worldTilt, glm::vec3(1.0f, 0.0f, 0.0f));
-
-	for (int i = 0; i < HORSES; i++)
-		horses.at(i)->setWorldRotation(worldRotation);
+	simulation->setWorldRotation(worldRotation);
 }
 
 GLuint importShaders(string vertex_shader_path, string fragment_shader_path)
@@ -903,224 +843,161 @@ unsigned int importTexture(char const *file_path)
 	return texture;
 }
 
-//Used for ongoing collisions.
-float distanceBetweenTwoPoints(float x1, float x2, float y1, float y2, float z1, float z2) {
-	return sqrt((x2 - x1)*(x2 - x1) + (y2 - y1)*(y2 - y1) + (z2 - z1)*(z2 - z1));
-}
-
-//Basic collision detection where if a horse's sphere is in another, they are collided.
-//Verified by checking if distance is smaller than the sum of the radii of each horse.
-bool sphereCollisionDetection(glm::vec3 pos1, glm::vec3 pos2, float radius1, float radius2)
-{
-	float distance = sqrt((pos2.x - pos1.x)*(pos2.x - pos1.x)
-		+ (pos2.y - pos2.y)*(pos2.y - pos2.y)
-		+ (pos2.z - pos1.z)*(pos2.z - pos1.z));
-	if (distance <= radius1 + radius2)
-		return true;
-	else
-		return false;
-}
-
-//Check if two horses would collide with each other in the next frame.
-bool collisionDetected(Horse* horse1, Horse* horse2, forecastDirection direction)
-{
-	glm::vec3 horseVec1 = horse1->getForecastedPosition(direction);
-	glm::vec3 horseVec2 = horse2->getForecastedPosition(direction);
-	float horseRadius1 = horse1->getCollisionRadius();
-	float horseRadius2 = horse2->getCollisionRadius();
-	return sphereCollisionDetection(horseVec1, horseVec2, horseRadius1, horseRadius2);
-}
-
-//Checks if a controlled horse and an independent horse would collide with each other in the next frame.
-bool collisionDetectedWithControlledHorse(Horse* controlledHorse, Horse* independentHorse)
+//Draw the shadow map and the scene with the poses evaluated this frame. Has to run on the thread that has the GL context.
+void renderFrame(GLuint shaderProgram, GLuint shadowShaderProgram, int width, int height, GLuint regularTextureLoc, GLuint shadowMapLoc)
 {
-	glm::vec3 horseVecControlled = controlledHorse->getForecastedPosition(straightDir);
-	glm::vec3 horseVecIndependent = independentHorse->getForecastedPosition(noDir);
-	float horseRadiusControlled = controlledHorse->getCollisionRadius();
-	float horseRadiusIndependent = independentHorse->getCollisionRadius();
-	return sphereCollisionDetection(horseVecControlled, horseVecIndependent, horseRadiusControlled, horseRadiusIndependent);
-}
-
-//Checks if horses are farther away from each other if the avoided horse goes straight.
-//This is done by checking if the distance calculated with no horse movement is smaller than the distance
-//calculated accounting for if the avoiding horse moves straight next frame
-bool isFartherFromCollision(Horse* stoppedHorse, Horse* avoidingHorse, forecastDirection direction)
-{
-	glm::vec3 horseVecStopped = stoppedHorse->getForecastedPosition(noDir);
-	glm::vec3 horseVecAvoidingBefore = avoidingHorse->getForecastedPosition(noDir);
-	glm::vec3 horseVecAvoidingAfter = avoidingHorse->getForecastedPosition(direction);
-	float distanceBefore = distanceBetweenTwoPoints(horseVecStopped.x, horseVecAvoidingBefore.x, horseVecStopped.y, horseVecAvoidingBefore.y, horseVecStopped.z, horseVecAvoidingBefore.z);
-	float distanceAfter = distanceBetweenTwoPoints(horseVecStopped.x, horseVecAvoidingAfter.x, horseVecStopped.y, horseVecAvoidingAfter.y, horseVecStopped.z, horseVecAvoidingAfter.z);
-	if (distanceBefore <= distanceAfter)
-		return true;
-	else
-		return false;
-}
-
-//Check if a horse is going out of bounds.
-bool goingOutOfBounds(Horse* avoidingHorse)
-{
-	glm::vec3 horseVec = avoidingHorse->getForecastedPosition(straightDir);
-	if ((horseVec.x >= -50.0f && horseVec.x <= 50.0f) && (horseVec.z >= -50.0f && horseVec.z <= 50.0f))
-		return false;
-	else
-		return true;
-}
-
-//The main collision resolution loop. Accounts for the following scenarios:
-//- Two normal horses collided.
-//- A normal horse and a collided horse collide.
-//- If two avoiding horses collide.
-//- Collision of independent horse and controlled horse.
-//- Collision of an avoiding horse and a stopped horse.
-void collisionResolutionDuring(Horse* horse1, Horse* horse2) {
-	//Two normal horses: Set one to avoid and the other to stop.
-	if (horse1->getCollisionStatus() == normal && horse2->getCollisionStatus() == normal) {
-		horse1->setCollisionStatus(randomNumber(0, 1) == 0 ? stopped : avoiding);
-		horse2->setCollisionStatus(horse1->getCollisionStatus() == stopped ? avoiding : stopped);
-	}
-	//A normal horse and a collided horse: Set the normal horse to stop.
-	else if (horse1->getCollisionStatus() == normal || horse2->getCollisionStatus() == normal)
-	{
-		Horse* normalHorse;
-		Horse* collidedHorse;
-		horse1->getCollisionStatus() == normal ? (normalHorse = horse1, collidedHorse = horse2) : (normalHorse = horse2, collidedHorse = horse1);
-		normalHorse->setCollisionStatus(stopped);
-	}
-	//Two avoiding horses: Randomly select one to stop.
-	else if (horse1->getCollisionStatus() == avoiding && horse2->getCollisionStatus() == avoiding) {
-		horse1->setCollisionStatus(randomNumber(0, 1) == 0 ? stopped : avoiding);
-		horse2->setCollisionStatus(horse1->getCollisionStatus() == stopped ? avoiding : stopped);
-	}
-	//Scenario when one horse is controlled by the user. Independent horse starts avoiding in this type of collision.
-	else if (horse1->getCollisionStatus() == controlled || horse2->getCollisionStatus() == controlled) {
-		Horse* controlledHorse;
-		Horse* independentHorse;
-		horse1->getCollisionStatus() == controlled ?
-			(horse2->setCollisionStatus(avoiding), controlledHorse = horse1, independentHorse = horse2) :
-			(horse1->setCollisionStatus(avoiding), controlledHorse = horse2, independentHorse = horse1);
-		//Avoiding horse should go straight if:
-		//- It goes farther from the collision
-		//- It doesn't go out of bounds
-		//- Previous collision checks for the avoiding horse doesn't tell it to go left or right.
-		if (isFartherFromCollision(controlledHorse, independentHorse, straightDir)
-			&& !goingOutOfBounds(independentHorse)
-			&& (independentHorse->getDirectionAssigned() == false || (independentHorse->getDirectionAssigned() == true && independentHorse->getAvoidingDirection() == straightDir)))
-			independentHorse->setAvoidingDirection(straightDir);
-		//Avoiding horse randomly decide to go left or right if not already assigned a direction (so horse doesn't alternate between left and right randomly).
-		else if (independentHorse->getAvoidingDirection() != leftDir && independentHorse->getAvoidingDirection() != rightDir) {
-			if (randomNumber(0, 1) == 0) {
-				if (isFartherFromCollision(independentHorse, independentHorse, leftDir))
-					independentHorse->setAvoidingDirection(leftDir);
-				else
-					independentHorse->setAvoidingDirection(rightDir);
-			}
-			else {
-				if (isFartherFromCollision(independentHorse, independentHorse, rightDir))
-					independentHorse->setAvoidingDirection(rightDir);
-				else
-					independentHorse->setAvoidingDirection(leftDir);
+	//Render
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);               //Clear the colorbuffer (i.e. set background color)
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //Clear color bit to update colors of all objects and clear depth bit to update depth bit of all objects.
+
+	model_matrix = glm::scale(model_matrix, glm::vec3(1.0f)); //Set a basis for coordinate measurements.
+
+	//FOR SHADOW SHADER
+	glm::mat4 shadow_view_matrix = glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	glm::mat4 shadow_projection_matrix = glm::perspective(PI / 2, (GLfloat)SHADOW_WIDTH / (GLfloat)SHADOW_HEIGHT, 1.0f, 25.0f);
+	//glm::mat4 shadow_projection_matrix = glm::ortho(-50.0f, 50.0f, -20.0f, 20.0f, -50.0f, 50.0f);
+
+	//Vectors used for the view matrix. Ensure that viewUp is the proper vector direction relative to viewPos. Keep viewCenter at the origin.
+	glm::vec3 viewPos = glm::vec3(0.0f, 20.0f, 0.0f);
+	glm::vec3 viewCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	glm::vec3 viewUp = glm::vec3(0.0f, 0.0f, -1.0f);
+
+	//Modify temporary variables used to influence the shiny part of the light.
+	//Uses spherical coordinates to get x, y and z variables due to movements being rotation based.
+	//x = distance*cos(theta)*sin(phi)
+	//y = distance*cos(phi)             (traditionally for z-axis but y-axis is considered up axis in this context).
+	//z = distance*sin(theta)*sin(phi)  (negated below due to program reversing the orientation of z-axis in comparison to natural world orientation).
+	tempViewPosX = 20.0f*cos(theta)*sin(phi);
+	tempViewPosY = 20.0f*cos(phi);
+	tempViewPosZ = -20.0f*sin(theta)*sin(phi);
+
+	glm::mat4 view_matrix;                                    //Dictates a camera's position and where the camera is facing.
+	view_matrix = (SimdMatrix(glm::lookAt(viewPos, viewCenter, viewUp))
+		*SimdMatrix(glm::translate(model_matrix, viewUp))
+		*SimdMatrix(glm::translate(model_matrix, (glm::cross(glm::normalize(viewPos), glm::normalize(viewUp)))
+		*(translateX)))
+		*SimdMatrix(glm::rotate(model_matrix, cameraTilt, glm::normalize(glm::cross(viewUp, viewPos))))
+		*SimdMatrix(glm::rotate(model_matrix, cameraPan, glm::vec3(0.0f, 1.0f, 0.0f)))).toMat4();
+
+	glm::mat4 projection_matrix;                              //Dictate's a camera's zoom and it's near and far planes.
+	projection_matrix = (SimdMatrix(glm::perspective(zoomValue, (GLfloat)width / (GLfloat)height, 0.1f, 100.0f))*
+		SimdMatrix(glm::scale(model_matrix, glm::vec3(windowAdjustmentX, windowAdjustmentY, 1.0f)))).toMat4(); //Let's camera be adaptable to current window size (near plane is 0.1f since z-buffering
+	//doesn't like near plane at 0.0f)
+
+	//Only upload the horses the camera or the light can see. The shadow camera only covers the middle of the field, and
+	//its projection is then narrowed to the horses it sees so the shadow map's resolution goes to them.
+	Frustum cameraFrustum((SimdMatrix(projection_matrix) * SimdMatrix(view_matrix)).toMat4());
+	Frustum lightFrustum((SimdMatrix(shadow_projection_matrix) * SimdMatrix(shadow_view_matrix)).toMat4());
+	horseCuller->cull(poseEvaluator, cameraFrustum, lightFrustum);
+	horseRenderer->upload(horseCuller);
+	shadow_projection_matrix = horseCuller->fitLightProjection(poseEvaluator, shadow_view_matrix, shadow_projection_matrix);
+
+	//Let both programs make use of the view and projection matrices (for the camera to get the proper view and the light to get the proper shadows).
+	FrameConstants frameConstants;
+	frameConstants.viewMatrix = view_matrix;
+	frameConstants.projectionMatrix = projection_matrix;
+	frameConstants.shadowViewMatrix = shadow_view_matrix;
+	frameConstants.shadowProjectionMatrix = shadow_projection_matrix;
+	frameConstants.lightColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);                                 //Set light color (currently white).
+	frameConstants.lightPosition = glm::vec4(0.0f, 20.0f, 0.0f, 1.0f);                             //Set light position (currently 20 units above initial horse position).
+	frameConstants.viewPosition = glm::vec4(tempViewPosX, tempViewPosY, tempViewPosZ, 1.0f);      //Use temporary camera position variables to influence specular lighting.
+	frameUniforms->update(frameConstants);
+
+	//Have the shadow map gather the proper depth values needed. Skipped while shadows are off, and kept from an earlier
+	//frame while neither the horses the light sees nor the grid changed (e.g. while the animation is paused).
+	if (shadowsActive) {
+		bool isStaticStale = shadowMap->needsStaticRedraw(shadow_projection_matrix, worldRotation, drawType);
+		if (isStaticStale || shadowMap->needsRedraw(horseCuller->getHaveLightCastersChanged())) {
+			glState->useProgram(shadowShaderProgram);
+			shadowPassTimer->begin();
+			if (isStaticStale) {
+				shadowMap->beginStatic(shadow_projection_matrix, worldRotation, drawType);
+				generateGrid(shadowShaderProgram, shadowTransformLoc, -1, -1);            //The shadow program has no normals or color.
 			}
+			shadowMap->beginDynamic();
+			horseRenderer->draw(shadowInstancedLoc, horseCuller->getLightFirstInstance(), horseCuller->getLightInstanceQuantity());
+			shadowPassTimer->end();
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		}
-		//Indicate that horse was assigned a direction.
-		if (independentHorse->getDirectionAssigned() == false)
-			independentHorse->setDirectionAssigned(true);
-	}
-	else if (horse1->getCollisionStatus() != normal && horse2->getCollisionStatus() != normal)
-	{
-		Horse* stoppedHorse;
-		Horse* avoidingHorse;
-		horse1->getCollisionStatus() == stopped ?
-			(stoppedHorse = horse1, avoidingHorse = horse2) :
-			(stoppedHorse = horse2, avoidingHorse = horse1);
-		//Avoiding horse should go straight if:
-		//- It goes farther from the collision
-		//- It doesn't go out of bounds
-		//- Previous collision checks for the avoiding horse doesn't tell it to go left or right.
-		if (isFartherFromCollision(stoppedHorse, avoidingHorse, straightDir)
-			&& !goingOutOfBounds(avoidingHorse)
-			&& (avoidingHorse->getDirectionAssigned() == false || (avoidingHorse->getDirectionAssigned() == true && avoidingHorse->getAvoidingDirection() == straightDir)))
-			avoidingHorse->setAvoidingDirection(straightDir);
-		//Avoiding horse randomly decides to go left or right if not already assigned a direction (so horse doesn't alternate between left and right randomly).
-		else if (avoidingHorse->getAvoidingDirection() != leftDir && avoidingHorse->getAvoidingDirection() != rightDir) {
-			if (randomNumber(0, 1) == 0) {
-				if (isFartherFromCollision(stoppedHorse, avoidingHorse, leftDir))
-					avoidingHorse->setAvoidingDirection(leftDir);
-				else
-					avoidingHorse->setAvoidingDirection(rightDir);
-			}
-			else {
-				if (isFartherFromCollision(stoppedHorse, avoidingHorse, rightDir))
-					avoidingHorse->setAvoidingDirection(rightDir);
-				else
-					avoidingHorse->setAvoidingDirection(leftDir);
-			}
-		}
-		//Indicate that horse was assigned a direction.
-		if (avoidingHorse->getDirectionAssigned() == false)
-			avoidingHorse->setDirectionAssigned(true);
-		//If a horse has turned 360 degrees (in general, not entirely left or right), we assume it's trapped and set it free.
-		//We do this by giving a horse that is collided with the avoiding horse avoiding behaviour while the other horse gets stopped
-		//behaviour. The one who collided with the avoided horse first gets avoid behaviour.
-		if (avoidingHorse->isTrapped()) {
-			avoidingHorse->setCollisionStatus(stopped);
-			avoidingHorse->setDirectionAssigned(false);
-			avoidingHorse->setAvoidingDirection(noDir);
-			Horse* newAvoidingHorse = horses.at(avoidingHorse->getCurrentCollision() - 1);
-			newAvoidingHorse->setCollisionStatus(avoiding);
-		}
-
-	}
-	//Update collision list of each horse.
-	if (!horse1->collisionTargetPresent(horse2->getId())) {
-		horse1->addCollision(horse2->getId());
-		horse2->addCollision(horse1->getId());
-	}
-}
-
-//Update collision properties for the horses if they are just getting out of a collision.
-void collisionResolutionEnd(Horse* horse1, Horse* horse2) {
-	Horse* stoppedHorse;
-	Horse* avoidingHorse;
-	horse1->getCollisionStatus() == stopped ?
-		(stoppedHorse = horse1, avoidingHorse = horse2) :
-		(stoppedHorse = horse2, avoidingHorse = horse1);
-	if (horse1->collisionTargetPresent(horse2->getId()))
-		horse1->removeCollision(horse2->getId());
-	if (horse2->collisionTargetPresent(horse1->getId()))
-		horse2->removeCollision(horse1->getId());
-	if (!horse1->doCollisionsExist()) {
-		horse1->setCollisionStatus(normal);
-		if (horse1->getAvoidingDirection() != noDir)
-			horse1->setAvoidingDirection(noDir);
-	}
-	if (!horse2->doCollisionsExist()) {
-		horse2->setCollisionStatus(normal);
-		if (horse2->getAvoidingDirection() != noDir)
-			horse2->setAvoidingDirection(noDir);
+		else
+			shadowMap->skip();
 	}
+	else
+		shadowMap->invalidate();
+
+	//Reset to window proportions (shadow map uses different proportions).
+	mainPassTimer->begin();
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	//Values that didn't change since the last frame are skipped by the state cache.
+	glState->useProgram(shaderProgram);
+	glState->setUniform(regularTextureLoc, 0);
+	glState->setUniform(shadowMapLoc, 1);
+	glState->setUniform(shadowsActiveLoc, shadowsActive);                         //Indicate to shader whether to apply shadows or not.
+
+	glState->bindTexture(GL_TEXTURE1, shadowMap->getDepthTexture());              //Bind shadow map to proper texture ID.
+	if (texturesActive)                                                           //Use horse skin texture if textures are active. Otherwise, use plain texture.
+		glState->bindTexture(GL_TEXTURE0, horseSkinTexture);
+	else
+		glState->bindTexture(GL_TEXTURE0, plainTexture);
+	horseRenderer->draw(instancedLoc, horseCuller->getCameraFirstInstance(), horseCuller->getCameraInstanceQuantity()); //Render horses.
+	if (texturesActive)                                                           //Use grass texture if textures are active. Otherwise, use plain texture.
+		glState->bindTexture(GL_TEXTURE0, grassTexture);
+	else
+		glState->bindTexture(GL_TEXTURE0, plainTexture);
+	generateGrid(shaderProgram, transformLoc, normalMatrixLoc, objectColorLocation); //Render floor.
+	mainPassTimer->end();
 }
 
-//Generate the floor of the scene.
-void generateGrid(GLuint shaderProgram)
+//Generate the floor of the scene. The locations are the model matrix, normal matrix and color uniforms of shaderProgram
+//(-1 if it has none).
+void generateGrid(GLuint shaderProgram, GLint modelMatrixLocation, GLint normalMatrixLocation, GLint colorLocation)
 {
 	glm::mat4 instance; //Variable that contains the transformation parameters of the current grid line.
 
 	//Set grid color to white.
-	glUseProgram(shaderProgram);
-	glUniform4f(objectColorLocation, 1.0f, 1.0f, 1.0f, 1.0f);
+	glState->useProgram(shaderProgram);
+	glState->setUniform(colorLocation, WHITE);
 
 	//Create the grid.
-	glBindVertexArray(gridVAO);
+	glState->bindVertexArray(gridVAO);
 	instance = worldRotation;
-	glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(instance));
+	glState->setUniform(modelMatrixLocation, instance);
+	glState->setUniform(normalMatrixLocation, glm::mat3(instance)); //The grid is only rotated, which is its own inverse transpose.
 	glDrawArrays(drawType, 0, indiceQuantity);
-	glBindVertexArray(0);
 }
 
-//Generates random integer from min to max
-int randomNumber(int min, int max)
+//Print the frame time percentiles and GPU pass times over the last few seconds, then write the zones recorded since the last
+//call to a trace file.
+void printProfile()
 {
-	return rand() % (max - min + 1) + min;
+	Profiler* profiler = Profiler::getInstance();
+	RollingStatistics* frameTimes = profiler->getFrameTimes();
+	GpuTimer* passTimers[] = { shadowPassTimer, mainPassTimer };
+
+	std::cout << "Frame time over the last " << frameTimes->getSampleQuantity() << " frames: p50 " << frameTimes->getPercentile(50)
+		<< " ms, p95 " << frameTimes->getPercentile(95) << " ms, p99 " << frameTimes->getPercentile(99) << " ms" << std::endl;
+	for (int i = 0; i < 2; i++) {
+		RollingStatistics* passTimes = passTimers[i]->getTimes();
+		std::cout << passTimers[i]->getName() << " (GPU): p50 " << passTimes->getPercentile(50) << " ms, p95 "
+			<< passTimes->getPercentile(95) << " ms, p99 " << passTimes->getPercentile(99) << " ms" << std::endl;
+	}
+	std::cout << "Horses last frame: " << horseCuller->getCameraVisibleQuantity() << " seen by the camera, " << horseCuller->getLightVisibleQuantity()
+		<< " seen by the light, " << horseCuller->getCulledQuantity() << " culled from both passes." << std::endl;
+	std::cout << "Shadow map: redrawn " << shadowMap->getRedrawQuantity() << " times (grid " << shadowMap->getStaticRedrawQuantity()
+		<< " times), kept " << shadowMap->getSkipQuantity() << " times." << std::endl;
+	std::cout << "GL state calls last frame: " << glState->getLastFrameIssuedCalls() << " issued, " << glState->getLastFrameSkippedCalls()
+		<< " skipped as redundant." << std::endl;
+	if (profiler->writeChromeTrace("profile.json")) {
+		std::cout << "Wrote " << profiler->getEventQuantity() << " events to profile.json (" << profiler->getDroppedEventQuantity()
+			<< " dropped)." << std::endl;
+#ifndef HORSE_PROFILE
+		std::cout << "Only frames and GPU passes are in the trace: CPU zones are compiled out without HORSE_PROFILE." << std::endl;
+#endif
+	}
+	else
+		std::cout << "Failed to write profile.json" << std::endl;
+	profiler->clearEvents();
 }
 
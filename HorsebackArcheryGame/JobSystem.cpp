@@ -0,0 +1,167 @@
+#include <algorithm>        //For min().
+#include "JobSystem.h"
+
+//workerQuantity threads are started on top of the calling thread (0 runs everything on the calling thread).
+JobSystem::JobSystem(int workerQuantity)
+{
+	isRunning = true;
+	queuedJobQuantity = 0;
+	for (int i = 0; i <= workerQuantity; i++)
+		queues.push_back(new WorkQueue());
+	threadIds.resize(workerQuantity + 1);
+	threadIds[0] = this_thread::get_id();
+	for (int i = 1; i <= workerQuantity; i++) {
+		workers.push_back(thread(&JobSystem::workerLoop, this, i));
+		threadIds[i] = workers.back().get_id();
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		lock_guard<mutex> guard(sleepLock);
+		isRunning = false;
+	}
+	wakeUp.notify_all();
+	for (int i = 0; i < workers.size(); i++)
+		workers[i].join();
+	for (int i = 0; i < queues.size(); i++)
+		delete queues[i];
+}
+
+//Queue of the calling thread. Threads that don't belong to the job system share queue 0.
+int JobSystem::getQueueIndex()
+{
+	thread::id id = this_thread::get_id();
+	for (int i = 1; i < threadIds.size(); i++)
+		if (threadIds[i] == id)
+			return i;
+	return 0;
+}
+
+//Newest job of the thread's own queue, otherwise the oldest job of the first other queue that has one.
+bool JobSystem::takeJob(int queueIndex, function<void()> &job)
+{
+	for (int i = 0; i < queues.size(); i++) {
+		WorkQueue* queue = queues[(queueIndex + i) % queues.size()];
+		lock_guard<mutex> guard(queue->lock);
+		if (queue->jobs.empty())
+			continue;
+		if (i == 0) {
+			job = move(queue->jobs.back());
+			queue->jobs.pop_back();
+		}
+		else {
+			job = move(queue->jobs.front());
+			queue->jobs.pop_front();
+		}
+		queuedJobQuantity--;
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::workerLoop(int queueIndex)
+{
+	function<void()> job;
+	while (isRunning) {
+		if (takeJob(queueIndex, job)) {
+			job();
+			continue;
+		}
+		unique_lock<mutex> guard(sleepLock);
+		wakeUp.wait(guard, [this] { return queuedJobQuantity > 0 || !isRunning; });
+	}
+}
+
+//Add a job to the calling thread's queue.
+void JobSystem::submit(function<void()> job)
+{
+	WorkQueue* queue = queues[getQueueIndex()];
+	{
+		lock_guard<mutex> guard(queue->lock);
+		queue->jobs.push_back(job);
+	}
+	{
+		lock_guard<mutex> guard(sleepLock);
+		queuedJobQuantity++;
+	}
+	wakeUp.notify_one();
+}
+
+//Run one queued job on the calling thread, if there is any. Used to help out while waiting on other jobs.
+bool JobSystem::runPendingJob()
+{
+	function<void()> job;
+	if (!takeJob(getQueueIndex(), job))
+		return false;
+	job();
+	return true;
+}
+
+//Run queued jobs on the calling thread until isDone() returns true, sleeping while there is nothing to run. Whatever
+//makes isDone() true has to call wakeWaiters() afterwards.
+void JobSystem::helpUntil(function<bool()> isDone)
+{
+	while (!isDone()) {
+		if (runPendingJob())
+			continue;
+		unique_lock<mutex> guard(sleepLock);
+		wakeUp.wait(guard, [this, &isDone] { return queuedJobQuantity > 0 || isDone(); });
+	}
+}
+
+//Wake every thread sleeping in helpUntil() (and the idle workers, which go back to sleep if there is nothing to do).
+void JobSystem::wakeWaiters()
+{
+	{
+		lock_guard<mutex> guard(sleepLock);
+	}
+	wakeUp.notify_all();
+}
+
+//Call body(begin, end) on consecutive ranges of at most grainSize out of 0 to quantity, spread over every thread, and
+//return once all of them are done. Ranges start at multiples of grainSize, also when there are no workers and every
+//range runs on the calling thread, so callers can keep per-range data indexed by begin / grainSize.
+void JobSystem::parallelFor(int quantity, int grainSize, function<void(int, int)> body)
+{
+	if (quantity <= 0)
+		return;
+	if (quantity <= grainSize || workers.empty()) {
+		for (int begin = 0; begin < quantity; begin += grainSize)
+			body(begin, min(quantity, begin + grainSize));
+		return;
+	}
+
+	//The range that finishes last wakes the calling thread.
+	int rangeQuantity = (quantity + grainSize - 1) / grainSize;
+	atomic<int> remainingRanges(rangeQuantity);
+	for (int i = 1; i < rangeQuantity; i++) {
+		int begin = i*grainSize;
+		int end = min(quantity, begin + grainSize);
+		submit([this, &body, &remainingRanges, begin, end] {
+			body(begin, end);
+			if (--remainingRanges == 0)
+				wakeWaiters();
+		});
+	}
+
+	//The calling thread takes the first range itself, then helps with whatever is left.
+	body(0, grainSize);
+	remainingRanges--;
+	helpUntil([&remainingRanges] { return remainingRanges == 0; });
+}
+
+//GETTERS
+//Workers plus the thread that created the job system.
+int JobSystem::getThreadQuantity()
+{
+	return queues.size();
+}
+
+//One worker per hardware thread besides the calling thread.
+int JobSystem::getDefaultWorkerQuantity()
+{
+	int hardwareThreads = thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
\ No newline at end of file
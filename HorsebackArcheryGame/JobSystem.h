@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+//Pool of worker threads that run jobs (any callable taking no arguments). Every thread has its own queue: a thread adds
+//and takes jobs at the back of its own queue and, when that runs dry, steals from the front of another thread's queue,
+//so threads mostly work on their own recent jobs and only touch each other's queues when they run out of work.
+//The thread that created the job system owns queue 0 and helps run jobs while it waits on them, so a job system
+//without workers simply runs every job on that thread.
+class JobSystem {
+	private:
+		struct WorkQueue {
+			mutex lock;
+			deque<function<void()> > jobs;
+		};
+
+		vector<WorkQueue*> queues;            //One per thread, queue 0 belongs to the thread that created the job system.
+		vector<thread> workers;
+		vector<thread::id> threadIds;         //Thread owning each queue.
+		atomic<bool> isRunning;
+
+		//Idle workers, and threads waiting in helpUntil(), sleep until jobs are queued.
+		mutex sleepLock;
+		condition_variable wakeUp;
+		atomic<int> queuedJobQuantity;
+
+		int getQueueIndex();
+		bool takeJob(int queueIndex, function<void()> &job);
+		void workerLoop(int queueIndex);
+	public:
+		JobSystem(int workerQuantity);
+		~JobSystem();
+		void submit(function<void()> job);
+		bool runPendingJob();
+		void helpUntil(function<bool()> isDone);
+		void wakeWaiters();
+		void parallelFor(int quantity, int grainSize, function<void(int, int)> body);
+
+		//GETTERS
+		int getThreadQuantity();
+		static int getDefaultWorkerQuantity();
+};
\ No newline at end of file
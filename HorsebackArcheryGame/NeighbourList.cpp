@@ -0,0 +1,91 @@
+#include <algorithm>        //For max() function.
+#include "NeighbourList.h"
+
+NeighbourList::NeighbourList(float fieldHalfSize, float skinParam)
+{
+	skin = skinParam;
+	grid = new SpatialGrid(fieldHalfSize);
+	entryQuantity = 0;
+	rangeSize = 1;
+	rebuildQuantity = 0;
+}
+
+//Whether the lists have to be built again: horses were added, or a horse moved more than half the skin since the last build.
+bool NeighbourList::needsRebuild(const float* positionsX, const float* positionsZ, int entryQuantityParam)
+{
+	if (entryQuantityParam != entryQuantity || rebuildQuantity == 0)
+		return true;
+	float largestDistanceSquared = 0.0f;
+	for (int i = 0; i < entryQuantity; i++) {
+		float distanceX = positionsX[i] - builtPositionsX[i];
+		float distanceZ = positionsZ[i] - builtPositionsZ[i];
+		largestDistanceSquared = max(largestDistanceSquared, distanceX*distanceX + distanceZ*distanceZ);
+	}
+	return largestDistanceSquared > 0.25f*skin*skin;
+}
+
+//Sort every horse into the grid and remember where it is. Has to come before the ranges are built, with cells wide
+//enough that every pair within reach is in neighbouring cells.
+void NeighbourList::beginRebuild(const float* positionsX, const float* positionsZ, int entryQuantityParam, float largestRadius, int rangeSizeParam)
+{
+	entryQuantity = entryQuantityParam;
+	rangeSize = rangeSizeParam;
+	builtPositionsX.assign(positionsX, positionsX + entryQuantity);
+	builtPositionsZ.assign(positionsZ, positionsZ + entryQuantity);
+	grid->rebuild(positionsX, positionsZ, entryQuantity, 2 * largestRadius + skin);
+
+	int rangeQuantity = (entryQuantity + rangeSize - 1) / rangeSize;
+	if (rangeNeighbours.size() < rangeQuantity) {
+		rangeNeighbours.resize(rangeQuantity);
+		rangeCandidatePairs.resize(rangeQuantity);
+	}
+	neighbourRange.resize(entryQuantity);
+	neighbourStart.resize(entryQuantity);
+	neighbourEnd.resize(entryQuantity);
+	rebuildQuantity++;
+}
+
+//List the neighbours of the horses from begin to end (starting at a multiple of the range size). Each pair is
+//only listed with its first horse, and every horse's neighbours are in ascending order, so going through the lists
+//horse by horse gives the pairs in the same order as the grid does. Different ranges can be built at the same time.
+void NeighbourList::rebuildRange(int begin, int end, const float* positionsX, const float* positionsZ, const float* radii)
+{
+	int range = begin / rangeSize;
+	vector<pair<int, int> > &candidatePairs = rangeCandidatePairs[range];
+	vector<int> &neighbours = rangeNeighbours[range];
+	grid->findCandidatePairs(begin, end, candidatePairs);
+	neighbours.clear();
+	int candidate = 0;
+	for (int i = begin; i < end; i++) {
+		neighbourRange[i] = range;
+		neighbourStart[i] = neighbours.size();
+		for (; candidate < candidatePairs.size() && candidatePairs[candidate].first == i; candidate++) {
+			int j = candidatePairs[candidate].second;
+			float distanceX = positionsX[j] - positionsX[i];
+			float distanceZ = positionsZ[j] - positionsZ[i];
+			float reach = radii[i] + radii[j] + skin;
+			if (distanceX*distanceX + distanceZ*distanceZ <= reach*reach)
+				neighbours.push_back(j);
+		}
+		neighbourEnd[i] = neighbours.size();
+	}
+}
+
+//GETTERS
+int NeighbourList::getNeighbourQuantity(int i)
+{
+	return neighbourEnd[i] - neighbourStart[i];
+}
+
+//Neighbours of horse i with a larger index, ascending.
+const int* NeighbourList::getNeighbours(int i)
+{
+	const vector<int> &neighbours = rangeNeighbours[neighbourRange[i]];
+	return neighbours.empty() ? NULL : &neighbours[neighbourStart[i]];
+}
+
+//How many times the lists were built so far.
+int NeighbourList::getRebuildQuantity()
+{
+	return rebuildQuantity;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include "SpatialGrid.h"
+
+using namespace std;
+
+//Every horse close enough to possibly collide with each horse (Verlet lists). Horses within the sum of their collision
+//radii plus a skin of each other are listed, and the lists are kept until some horse has moved more than half the skin
+//since they were built: until then no two horses can have closed the gap to a collision without one of them moving that
+//far, so the lists are still complete. Horses move at most MAX_SPEED a frame, so the lists last a few frames and only
+//the pairs in them are tested in between.
+//Lists are built per range of horses, so ranges can be built on different threads.
+class NeighbourList {
+	private:
+		float skin;                              //Extra distance listed on top of the collision radii.
+		SpatialGrid* grid;                       //Finds the candidates when the lists are built.
+		int entryQuantity;
+		int rangeSize;                           //Horses per range.
+		vector<float> builtPositionsX;           //Where every horse was when the lists were built.
+		vector<float> builtPositionsZ;
+		vector<vector<pair<int, int> > > rangeCandidatePairs;  //Grid candidates of each range while building.
+		vector<vector<int> > rangeNeighbours;    //Neighbours of every horse of each range, horse after horse.
+		vector<int> neighbourRange;              //Per horse: which range's list holds its neighbours...
+		vector<int> neighbourStart;              //...where they start...
+		vector<int> neighbourEnd;                //...and end.
+		int rebuildQuantity;
+	public:
+		NeighbourList(float fieldHalfSize, float skinParam);
+		bool needsRebuild(const float* positionsX, const float* positionsZ, int entryQuantityParam);
+		void beginRebuild(const float* positionsX, const float* positionsZ, int entryQuantityParam, float largestRadius, int rangeSizeParam);
+		void rebuildRange(int begin, int end, const float* positionsX, const float* positionsZ, const float* radii);
+
+		//GETTERS
+		int getNeighbourQuantity(int i);
+		const int* getNeighbours(int i);
+		int getRebuildQuantity();
+};
\ No newline at end of file
@@ -1,71 +1,59 @@
 #include "Node.h"
 
-//Default color is white. Matrices always have a default since both matrices have setters.
+//A root body part of unit size that doesn't move.
 Node::Node()
 {
-	color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f));
-	scaleMatrix = glm::scale(modelMatrix, glm::vec3(1.0f));
-	rotTransMatrix = glm::translate(modelMatrix, glm::vec3(0.0f))*glm::rotate(modelMatrix, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+	parent = -1;
+	joint = -1;
+	restAngle = 0.0f;
+	offset = glm::vec3(0.0f);
+	pivot = glm::vec3(0.0f);
+	shape = glm::vec3(1.0f);
 }
 
-//Allows one to choose the color of the horse's body part.
-Node::Node(glm::vec4 &colorParam)
+//Allows one to choose where the body part hangs off of its parent, how it rotates and its shape.
+Node::Node(int parentParam, int jointParam, float restAngleParam, glm::vec3 offsetParam, glm::vec3 pivotParam, glm::vec3 shapeParam)
 {
-	color = colorParam;
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f));
-	scaleMatrix = glm::scale(modelMatrix, glm::vec3(1.0f));
-	rotTransMatrix = glm::translate(modelMatrix, glm::vec3(0.0f))*glm::rotate(modelMatrix, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+	parent = parentParam;
+	joint = jointParam;
+	restAngle = restAngleParam;
+	offset = offsetParam;
+	pivot = pivotParam;
+	shape = shapeParam;
 }
 
-//Establish that a certain body part is a child of the current body part.
-void Node::addChild(Node* child)
+//Getter for parent
+int Node::getParent()
 {
-	children.push_back(child);
+	return parent;
 }
 
-//Setter for both matrices.
-void Node::setMatrices(glm::mat4 &scaleMatrixParam, glm::mat4 &rotTransMatrixParam)
+//Getter for the joint angle the body part rotates with.
+int Node::getJoint()
 {
-	scaleMatrix = scaleMatrixParam;
-	rotTransMatrix = rotTransMatrixParam;
+	return joint;
 }
 
-//Setter for color
-void Node::setColor(glm::vec4 &colorParam) {
-	color = colorParam;
-}
-
-//Getter for color
-glm::vec4 Node::getColor()
+//Getter for the rest angle.
+float Node::getRestAngle()
 {
-	return color;
+	return restAngle;
 }
 
-//Getter for scale matrix
-glm::mat4 Node::getScaleMatrix()
+//Getter for the offset from the parent.
+const glm::vec3& Node::getOffset()
 {
-	return scaleMatrix;
+	return offset;
 }
 
-//Getter for rotation-translation matrix.
-glm::mat4 Node::getRotTransMatrix()
+//Getter for the pivot.
+const glm::vec3& Node::getPivot()
 {
-	return rotTransMatrix;
-}
-
-//Retrieve a child of a particular body part.
-Node* Node::getChildAt(int i) {
-	return children.at(i);
-}
-
-//How many body parts attached to parent body part.
-int Node::getChildQuantity() {
-	return children.size();
+	return pivot;
 }
 
-//Allows new instances of node to have the proper byte boundaries (they change since glm::mat4 parameters are passed)!
-void* Node::operator new(size_t i)
+//Getter for the scale along each axis.
+const glm::vec3& Node::getShape()
 {
-	return _mm_malloc(i, 16);
+	return shape;
 }
\ No newline at end of file
@@ -1,32 +1,32 @@
-#include <vector>
+#pragma once
+
 #include "glm.hpp"
 #include "gtc/matrix_transform.hpp"
 #include "gtc/type_ptr.hpp"
 
-using namespace std;
-
 #ifndef Node_H
 #define Node_H
 #endif
 
+//One body part of a skeleton. Body parts refer to their parent by its position in the tree instead of holding pointers
+//to their children, so a whole skeleton fits in one array. Nothing in here changes once the skeleton is built: lengths
+//are in units of the size of the horse using it, and the angle comes from that horse's pose.
 class Node {
 	private:
-		glm::vec4 color;             //Various properties of each node required to draw the body part's shape and color.
-		glm::mat4 modelMatrix;
-		glm::mat4 scaleMatrix;
-		glm::mat4 rotTransMatrix;
-		vector<Node*> children;      //All the body parts that move alongside the current body part in question.
+		int parent;                  //Position of the body part this one hangs off of in the tree (-1 for the root).
+		int joint;                   //Joint angle that rotates the body part around z (-1 for the root, which is placed by its horse).
+		float restAngle;             //Added to the joint angle.
+		glm::vec3 offset;            //Where the body part hangs off of its parent.
+		glm::vec3 pivot;             //Point the body part rotates around, relative to the offset.
+		glm::vec3 shape;             //Scale along each axis. Not passed on to children (doing so results in shears!).
 
 	public:
 		Node();
-		Node(glm::vec4 &colorParam);
-		void addChild(Node* child);
-		void setMatrices(glm::mat4 &scaleMatrixParam, glm::mat4 &rotTransMatrixParam);
-		void setColor(glm::vec4 &colorParam);
-		glm::vec4 getColor();
-		glm::mat4 getScaleMatrix();
-		glm::mat4 getRotTransMatrix();
-		Node* getChildAt(int childParam);
-		int getChildQuantity();
-		void* operator new(size_t i);
+		Node(int parentParam, int jointParam, float restAngleParam, glm::vec3 offsetParam, glm::vec3 pivotParam, glm::vec3 shapeParam);
+		int getParent();
+		int getJoint();
+		float getRestAngle();
+		const glm::vec3& getOffset();
+		const glm::vec3& getPivot();
+		const glm::vec3& getShape();
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <string.h>         //For memcmp() and memcpy().
+#include <atomic>
+#include "PoseEvaluator.h"
+#include "Profiler.h"
+
+PoseEvaluator::PoseEvaluator()
+{
+	horseQuantity = 0;
+	recordedQuantity = 0;
+	evaluatedQuantity = 0;
+	evaluatedBodyPartQuantity = 0;
+	jobs = new JobSystem(0);    //Everything runs on the calling thread until a job system with workers is set.
+}
+
+//Call after every simulation tick. The last tick becomes the previous one. Horses that didn't exist yet start out with
+//both ticks the same so they don't slide in from the origin.
+void PoseEvaluator::recordTick(Simulation* simulation)
+{
+	int quantity = simulation->getHorseQuantity();
+	previousTickKeys.swap(currentTickKeys);
+	previousTickKeys.resize(quantity*Horse::POSE_KEY_SIZE);
+	currentTickKeys.resize(quantity*Horse::POSE_KEY_SIZE);
+	for (int i = 0; i < quantity; i++)
+		simulation->getHorse(i)->getPoseKey(&currentTickKeys[i*Horse::POSE_KEY_SIZE]);
+	for (int i = recordedQuantity; i < quantity; i++)
+		memcpy(&previousTickKeys[i*Horse::POSE_KEY_SIZE], &currentTickKeys[i*Horse::POSE_KEY_SIZE], Horse::POSE_KEY_SIZE*sizeof(float));
+	recordedQuantity = quantity;
+}
+
+//Compute the pose of every horse that changed since last frame and gather the colors of every body part. alpha is how far
+//the frame is between the previous tick (0) and the last tick (1). Only the motion part of the pose key is interpolated,
+//the world rotation is taken from the last tick.
+void PoseEvaluator::evaluate(Simulation* simulation, float alpha)
+{
+	PROFILE_ZONE("Evaluate poses");
+
+	//Horses added since the last tick have nothing to interpolate from yet.
+	if (recordedQuantity < simulation->getHorseQuantity())
+		recordTick(simulation);
+
+	horseQuantity = simulation->getHorseQuantity();
+	worldMatrices.resize(horseQuantity*bodyPartQuantity);
+	modelMatrices.resize(horseQuantity*bodyPartQuantity);
+	normalMatrices.resize(horseQuantity*bodyPartQuantity);
+	colors.resize(horseQuantity*bodyPartQuantity);
+	boundingSpheres.resize(horseQuantity);
+	poseKeys.resize(horseQuantity*Horse::POSE_KEY_SIZE);
+	isEvaluated.resize(horseQuantity, 0);
+
+	//Horses share a skeleton that nothing writes to and every horse only touches its own part of the buffers, so ranges of
+	//horses are evaluated in parallel.
+	atomic<int> evaluatedTotal(0);
+	atomic<int> evaluatedBodyPartTotal(0);
+	jobs->parallelFor(horseQuantity, HORSES_PER_TASK, [this, simulation, alpha, &evaluatedTotal, &evaluatedBodyPartTotal](int begin, int end) {
+		int rangeEvaluatedQuantity = 0;
+		int rangeEvaluatedBodyPartQuantity = 0;
+		for (int i = begin; i < end; i++) {
+			int bodyParts = evaluateHorse(simulation->getHorse(i), i, alpha);
+			if (bodyParts > 0)
+				rangeEvaluatedQuantity++;
+			rangeEvaluatedBodyPartQuantity += bodyParts;
+		}
+		evaluatedTotal += rangeEvaluatedQuantity;
+		evaluatedBodyPartTotal += rangeEvaluatedBodyPartQuantity;
+	});
+	evaluatedQuantity = evaluatedTotal;
+	evaluatedBodyPartQuantity = evaluatedBodyPartTotal;
+}
+
+//Interpolate the pose key of one horse, compute its pose if the key changed and gather its colors. Returns how many body
+//parts had to be computed (0 when the pose didn't change).
+int PoseEvaluator::evaluateHorse(Horse* horse, int i, float alpha)
+{
+	int computedQuantity = 0;
+	float poseKey[Horse::POSE_KEY_SIZE];
+	const float* previousTickKey = &previousTickKeys[i*Horse::POSE_KEY_SIZE];
+	const float* currentTickKey = &currentTickKeys[i*Horse::POSE_KEY_SIZE];
+	float* lastPoseKey = &poseKeys[i*Horse::POSE_KEY_SIZE];
+
+	//Written as a weighted sum so alpha 0 and 1 give exactly the previous and last tick.
+	for (int j = 0; j < Horse::MOTION_KEY_SIZE; j++)
+		poseKey[j] = previousTickKey[j] * (1.0f - alpha) + currentTickKey[j] * alpha;
+	for (int j = Horse::MOTION_KEY_SIZE; j < Horse::POSE_KEY_SIZE; j++)
+		poseKey[j] = currentTickKey[j];
+
+	if (!isEvaluated[i] || memcmp(poseKey, lastPoseKey, sizeof(poseKey)) != 0) {
+		int first = i*bodyPartQuantity;
+		computedQuantity = horse->evaluatePose(poseKey, isEvaluated[i] ? lastPoseKey : NULL, &worldMatrices[first], &modelMatrices[first],
+			&normalMatrices[first]);
+		memcpy(lastPoseKey, poseKey, sizeof(poseKey));
+		isEvaluated[i] = 1;
+		boundingSpheres[i] = horse->getBoundingSphere(poseKey);
+	}
+
+	//Colors change without the pose changing (selection, debug colors) so they are always gathered.
+	glm::vec4 color = horse->getColor();
+	for (int j = 0; j < bodyPartQuantity; j++)
+		colors[i*bodyPartQuantity + j] = color;
+	return computedQuantity;
+}
+
+//GETTERS
+int PoseEvaluator::getHorseQuantity()
+{
+	return horseQuantity;
+}
+
+int PoseEvaluator::getEvaluatedQuantity()
+{
+	return evaluatedQuantity;
+}
+
+int PoseEvaluator::getEvaluatedBodyPartQuantity()
+{
+	return evaluatedBodyPartQuantity;
+}
+
+//SETTERS
+//The job system is shared (see Simulation::setJobSystem()).
+void PoseEvaluator::setJobSystem(JobSystem* jobsParam)
+{
+	jobs = jobsParam;
+}
+
+//Model matrices of every body part of every horse, bodyPartQuantity per horse.
+const glm::mat4* PoseEvaluator::getModelMatrices()
+{
+	return modelMatrices.empty() ? NULL : &modelMatrices[0];
+}
+
+//Normal matrices of every body part of every horse, same order as the model matrices.
+const NormalMatrix* PoseEvaluator::getNormalMatrices()
+{
+	return normalMatrices.empty() ? NULL : &normalMatrices[0];
+}
+
+const glm::vec4* PoseEvaluator::getColors()
+{
+	return colors.empty() ? NULL : &colors[0];
+}
+
+//Bounding sphere of every horse (xyz center, w radius).
+const glm::vec4* PoseEvaluator::getBoundingSpheres()
+{
+	return boundingSpheres.empty() ? NULL : &boundingSpheres[0];
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include "Simulation.h"
+#include "JobSystem.h"
+
+using namespace std;
+
+//Turns the herd's state into what every body part is drawn with, once per rendered frame. The simulation runs in fixed
+//ticks that don't line up with rendered frames, so the pose key of every horse is recorded after each tick and the pose
+//drawn is interpolated between the last two ticks (which puts what's drawn up to one tick behind the simulation).
+//The result is a per-frame buffer that every render pass reads without changing it (shadow pass and main pass draw the
+//exact same pose). Horses whose interpolated pose key is the same as last frame keep last frame's matrices instead of
+//being computed again.
+class PoseEvaluator {
+	private:
+		const int HORSES_PER_TASK = 64;    //Horses evaluated by one task when the work is split over threads.
+
+		JobSystem* jobs;                   //Threads the horses are spread over.
+		int horseQuantity;
+		int recordedQuantity;              //Amount of horses whose ticks have been recorded.
+		int evaluatedQuantity;             //Amount of horses whose pose had to be computed in the last evaluation.
+		int evaluatedBodyPartQuantity;     //Amount of body parts among them that moved and had to be computed.
+		vector<glm::mat4> worldMatrices;   //bodyPartQuantity matrices per horse, horse by horse, body parts in tree order.
+		vector<glm::mat4> modelMatrices;   //World matrix times the body part's scale, same order.
+		vector<NormalMatrix> normalMatrices; //Normal matrix of every body part, same order as the model matrices.
+		vector<glm::vec4> colors;          //Color of every body part, same order as the matrices.
+		vector<glm::vec4> boundingSpheres; //Of every horse in the evaluated pose (see Horse::getBoundingSphere()).
+		vector<float> previousTickKeys;    //Pose key of every horse at the tick before the last one (Horse::POSE_KEY_SIZE each).
+		vector<float> currentTickKeys;     //Pose key of every horse at the last tick.
+		vector<float> poseKeys;            //What every horse's pose was computed from last time (the joint angles and root
+		                                   //transform the matrices above were built from).
+		vector<char> isEvaluated;          //Whether a horse's pose has been computed at least once (not vector<bool>, whose
+		                                   //elements share bytes and can't be written from different threads).
+		int evaluateHorse(Horse* horse, int i, float alpha);
+	public:
+		PoseEvaluator();
+		void recordTick(Simulation* simulation);
+		void evaluate(Simulation* simulation, float alpha);
+
+		//GETTERS
+		int getHorseQuantity();
+		int getEvaluatedQuantity();
+		int getEvaluatedBodyPartQuantity();
+		const glm::mat4* getModelMatrices();
+		const NormalMatrix* getNormalMatrices();
+		const glm::vec4* getColors();
+		const glm::vec4* getBoundingSpheres();
+
+		//SETTERS
+		void setJobSystem(JobSystem* jobsParam);
+};
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <fstream>
+#include "Profiler.h"
+
+Profiler::Profiler()
+{
+	origin = chrono::high_resolution_clock::now();
+	lastFrameMark = -1.0;
+	frameTimes = new RollingStatistics(FRAME_HISTORY);
+	droppedEventQuantity = 0;
+}
+
+Profiler* Profiler::getInstance()
+{
+	static Profiler instance;
+	return &instance;
+}
+
+//Microseconds since the profiler was created.
+double Profiler::getTime()
+{
+	return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - origin).count();
+}
+
+//Call once per frame at the same point of the loop. The time since the last call is the frame time.
+void Profiler::markFrame()
+{
+	double now = getTime();
+	if (lastFrameMark >= 0.0) {
+		frameTimes->addSample((now - lastFrameMark) / 1000.0);
+		addEvent("Frame", lastFrameMark, now - lastFrameMark, cpuTrack);
+	}
+	lastFrameMark = now;
+}
+
+void Profiler::addEvent(const char* name, double start, double duration, profileTrack track)
+{
+	lock_guard<mutex> guard(eventLock);
+	if (events.size() >= MAX_EVENTS) {
+		droppedEventQuantity++;
+		return;
+	}
+
+	int threadIndex = 0;
+	if (track == cpuTrack) {
+		thread::id id = this_thread::get_id();
+		while (threadIndex < threadIds.size() && threadIds[threadIndex] != id)
+			threadIndex++;
+		if (threadIndex == threadIds.size())
+			threadIds.push_back(id);
+	}
+	ProfileEvent event = { name, start, duration, track, threadIndex };
+	events.push_back(event);
+}
+
+void Profiler::clearEvents()
+{
+	lock_guard<mutex> guard(eventLock);
+	events.clear();
+	droppedEventQuantity = 0;
+}
+
+//Write every event as a complete ("X") event of the Chrome trace event format. Returns false if the file can't be written.
+bool Profiler::writeChromeTrace(const char* path)
+{
+	ofstream file(path, ios::out | ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	//The GPU gets the first row (tid 0), then one row per CPU thread.
+	lock_guard<mutex> guard(eventLock);
+	file.setf(ios::fixed);
+	file.precision(3);
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+	for (int i = 0; i < threadIds.size(); i++)
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i + 1 << ",\"args\":{\"name\":\"CPU " << i << "\"}}";
+	for (int i = 0; i < events.size(); i++) {
+		int tid = events[i].track == gpuTrack ? 0 : events[i].threadIndex + 1;
+		file << ",\n{\"name\":\"" << events[i].name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+			<< ",\"ts\":" << events[i].start << ",\"dur\":" << events[i].duration << "}";
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
+
+//GETTERS
+RollingStatistics* Profiler::getFrameTimes()
+{
+	return frameTimes;
+}
+
+int Profiler::getEventQuantity()
+{
+	lock_guard<mutex> guard(eventLock);
+	return events.size();
+}
+
+int Profiler::getDroppedEventQuantity()
+{
+	return droppedEventQuantity;
+}
+
+ProfileZone::ProfileZone(const char* nameParam)
+{
+	name = nameParam;
+	start = Profiler::getInstance()->getTime();
+}
+
+ProfileZone::~ProfileZone()
+{
+	Profiler* profiler = Profiler::getInstance();
+	profiler->addEvent(name, start, profiler->getTime() - start, cpuTrack);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <chrono>           //For timing zones and frames.
+#include <thread>
+#include <mutex>
+#include "RollingStatistics.h"
+
+using namespace std;
+
+//CPU zones are only recorded when HORSE_PROFILE is defined. Otherwise PROFILE_ZONE expands to nothing and costs nothing.
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+#ifdef HORSE_PROFILE
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCATENATE(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+//Which row of the trace an event is shown on.
+enum profileTrack { cpuTrack, gpuTrack };
+
+//A span of time that was measured. The name is kept as a pointer so it has to be a string literal.
+struct ProfileEvent {
+	const char* name;
+	double start;     //Microseconds since the profiler was created.
+	double duration;  //Microseconds.
+	profileTrack track;
+	int threadIndex;  //Which CPU thread recorded the event (in the order threads first recorded one, 0 for GPU events).
+};
+
+//Collects the zones and frame times of the whole program (there is one instance, see getInstance()). Frame times are
+//always kept. Frames, GPU passes and (with HORSE_PROFILE defined) zones are also kept as events until there are
+//MAX_EVENTS of them (or until clearEvents()) and can be written out as a Chrome trace (open it in chrome://tracing or
+//https://ui.perfetto.dev). Events can be added from any thread.
+class Profiler {
+	private:
+		static const int FRAME_HISTORY = 600;   //Frames used for the frame time percentiles (10 seconds at 60 fps).
+		static const int MAX_EVENTS = 1000000;  //Events past this are dropped so a long session can't use up memory.
+
+		chrono::high_resolution_clock::time_point origin;
+		double lastFrameMark;                   //Time of the last markFrame() call, negative before the first one.
+		RollingStatistics* frameTimes;          //Milliseconds.
+		vector<ProfileEvent> events;
+		int droppedEventQuantity;
+		vector<thread::id> threadIds;           //CPU threads that recorded events, by their index in the trace.
+		mutex eventLock;                        //Guards events, droppedEventQuantity and threadIds.
+
+		Profiler();
+	public:
+		static Profiler* getInstance();
+		double getTime();
+		void markFrame();
+		void addEvent(const char* name, double start, double duration, profileTrack track);
+		void clearEvents();
+		bool writeChromeTrace(const char* path);
+
+		//GETTERS
+		RollingStatistics* getFrameTimes();
+		int getEventQuantity();
+		int getDroppedEventQuantity();
+};
+
+//Measures the time between its construction and the end of the scope it's declared in. Use it through PROFILE_ZONE.
+class ProfileZone {
+	private:
+		const char* name;
+		double start;
+	public:
+		ProfileZone(const char* nameParam);
+		~ProfileZone();
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <algorithm>        //For sort().
+#include <math.h>           //For ceil().
+#include "RollingStatistics.h"
+
+RollingStatistics::RollingStatistics(int capacity)
+{
+	samples.resize(capacity);
+	sortedSamples.reserve(capacity);
+	sampleQuantity = 0;
+	nextSample = 0;
+}
+
+//Once the ring is full the oldest sample is replaced.
+void RollingStatistics::addSample(double sample)
+{
+	samples[nextSample] = sample;
+	nextSample = (nextSample + 1) % samples.size();
+	if (sampleQuantity < samples.size())
+		sampleQuantity++;
+}
+
+void RollingStatistics::clear()
+{
+	sampleQuantity = 0;
+	nextSample = 0;
+}
+
+//GETTERS
+//Nearest rank percentile (0 to 100) of the samples in the ring. Returns 0 when there are no samples.
+double RollingStatistics::getPercentile(double percentile)
+{
+	if (sampleQuantity == 0)
+		return 0.0;
+
+	sortedSamples.assign(samples.begin(), samples.begin() + sampleQuantity);
+	sort(sortedSamples.begin(), sortedSamples.end());
+	int rank = (int)ceil(percentile / 100.0 * sampleQuantity);
+	if (rank < 1)
+		rank = 1;
+	if (rank > sampleQuantity)
+		rank = sampleQuantity;
+	return sortedSamples[rank - 1];
+}
+
+double RollingStatistics::getAverage()
+{
+	if (sampleQuantity == 0)
+		return 0.0;
+
+	double sum = 0.0;
+	for (int i = 0; i < sampleQuantity; i++)
+		sum += samples[i];
+	return sum / sampleQuantity;
+}
+
+int RollingStatistics::getSampleQuantity()
+{
+	return sampleQuantity;
+}
+
+int RollingStatistics::getCapacity()
+{
+	return samples.size();
+}
\ No newline at end of file
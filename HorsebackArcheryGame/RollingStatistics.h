@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+//Keeps the most recent samples of a measurement (e.g. frame times) in a ring and reports percentiles over them.
+class RollingStatistics {
+	private:
+		vector<double> samples;        //Ring of the most recent samples.
+		vector<double> sortedSamples;  //Scratch space for percentiles (reused to avoid reallocating).
+		int sampleQuantity;
+		int nextSample;                //Slot the next sample overwrites.
+	public:
+		RollingStatistics(int capacity);
+		void addSample(double sample);
+		void clear();
+
+		//GETTERS
+		double getPercentile(double percentile);
+		double getAverage();
+		int getSampleQuantity();
+		int getCapacity();
+};
\ No newline at end of file
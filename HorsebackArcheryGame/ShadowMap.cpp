@@ -0,0 +1,117 @@
+#include "ShadowMap.h"
+#include <string.h>         //For memcmp().
+
+ShadowMap::ShadowMap(int widthParam, int heightParam)
+{
+	width = widthParam;
+	height = heightParam;
+	isStaticCurrent = false;
+	isCurrent = false;
+	staticDrawType = -1;
+	redrawQuantity = 0;
+	staticRedrawQuantity = 0;
+	skipQuantity = 0;
+
+	glGenFramebuffers(1, &FBO);
+	depthTexture = createDepthTexture(FBO);
+	glGenFramebuffers(1, &staticFBO);
+	staticDepthTexture = createDepthTexture(staticFBO);
+}
+
+//Attach a new depth texture to a framebuffer (the frame buffer is important for applying the shadow map before drawing
+//the scene itself). Lookups outside the texture read the far plane, so whatever the light projection doesn't cover is lit.
+GLuint ShadowMap::createDepthTexture(GLuint framebuffer)
+{
+	GLuint texture;
+	GLfloat farDepth[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, farDepth);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return texture;
+}
+
+//Forget what the map holds (while shadows are off nothing keeps it up to date).
+void ShadowMap::invalidate()
+{
+	isCurrent = false;
+}
+
+//Whether the grid has to be drawn again (before beginDynamic()) for this light projection, world rotation and draw type.
+bool ShadowMap::needsStaticRedraw(const glm::mat4& projection, const glm::mat4& worldRotation, int drawType)
+{
+	return !isStaticCurrent || drawType != staticDrawType || memcmp(&projection, &staticProjection, sizeof(glm::mat4)) != 0
+		|| memcmp(&worldRotation, &staticWorldRotation, sizeof(glm::mat4)) != 0;
+}
+
+//Whether the map has to be drawn this frame. Call after needsStaticRedraw() and redraw the grid first if it asked to.
+bool ShadowMap::needsRedraw(bool haveCastersChanged)
+{
+	return !isCurrent || haveCastersChanged;
+}
+
+//Bind and clear the static depth so the grid can be drawn into it. Has to be followed by beginDynamic().
+void ShadowMap::beginStatic(const glm::mat4& projection, const glm::mat4& worldRotation, int drawType)
+{
+	staticProjection = projection;
+	staticWorldRotation = worldRotation;
+	staticDrawType = drawType;
+	isStaticCurrent = true;
+	isCurrent = false;          //The map starts from the static depth, so it has to follow.
+	staticRedrawQuantity++;
+
+	glViewport(0, 0, width, height);
+	glBindFramebuffer(GL_FRAMEBUFFER, staticFBO);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+//Copy the static depth into the map and bind it so the horses can be drawn on top.
+void ShadowMap::beginDynamic()
+{
+	isCurrent = true;
+	redrawQuantity++;
+
+	glViewport(0, 0, width, height);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+}
+
+//Count a frame that kept the map from an earlier one.
+void ShadowMap::skip()
+{
+	skipQuantity++;
+}
+
+//GETTERS
+GLuint ShadowMap::getDepthTexture()
+{
+	return depthTexture;
+}
+
+int ShadowMap::getRedrawQuantity()
+{
+	return redrawQuantity;
+}
+
+int ShadowMap::getStaticRedrawQuantity()
+{
+	return staticRedrawQuantity;
+}
+
+int ShadowMap::getSkipQuantity()
+{
+	return skipQuantity;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "..\glew\glew.h"	//include GL Extension Wrangler
+#include "..\glfw\glfw3.h"	//include GLFW helper library
+#include "glm.hpp"
+
+//Depth map of the scene as the light sees it, kept between frames. The static part of the scene (the grid) is drawn
+//into its own depth texture and only redrawn when the light projection, world rotation or draw type change. The map
+//itself starts from a copy of that and gets the horses drawn on top, and is only redrawn when something it holds changed.
+class ShadowMap {
+	private:
+		int width;
+		int height;
+		GLuint depthTexture;        //What the main pass samples.
+		GLuint FBO;
+		GLuint staticDepthTexture;  //Depth of the grid alone.
+		GLuint staticFBO;
+		bool isStaticCurrent;
+		bool isCurrent;
+		glm::mat4 staticProjection; //What the static depth was drawn with.
+		glm::mat4 staticWorldRotation;
+		int staticDrawType;
+		int redrawQuantity;
+		int staticRedrawQuantity;
+		int skipQuantity;
+
+		GLuint createDepthTexture(GLuint framebuffer);
+	public:
+		ShadowMap(int widthParam, int heightParam);
+		void invalidate();
+		bool needsStaticRedraw(const glm::mat4& projection, const glm::mat4& worldRotation, int drawType);
+		bool needsRedraw(bool haveCastersChanged);
+		void beginStatic(const glm::mat4& projection, const glm::mat4& worldRotation, int drawType);
+		void beginDynamic();
+		void skip();
+
+		//GETTERS
+		GLuint getDepthTexture();
+		int getRedrawQuantity();
+		int getStaticRedrawQuantity();
+		int getSkipQuantity();
+};
\ No newline at end of file
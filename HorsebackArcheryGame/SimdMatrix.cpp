@@ -0,0 +1,11 @@
+#include "SimdMatrix.h"
+
+//Which types matrices are composed on (for the benchmarks).
+const char* SimdMatrix::getBackendName()
+{
+#if defined(HORSE_SIMD_MATRICES)
+	return "glm SSE";
+#else
+	return "glm scalar";
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "glm.hpp"
+#include "HorseHerd.h"      //For the HORSE_SIMD_ macros.
+
+//Matrices are composed on glm's SSE types (simdMat4 and simdVec4) along with the other SIMD kernels, and on plain glm
+//types when HORSE_NO_SIMD is defined or the compiler has no SSE2. glm's SIMD headers include "glm/glm.hpp", so the
+//folder holding glm has to be on the include path as well as glm itself.
+#if (defined(HORSE_SIMD_AVX) || defined(HORSE_SIMD_SSE)) && (GLM_ARCH & GLM_ARCH_SSE2)
+#define HORSE_SIMD_MATRICES
+#include "gtx/simd_mat4.hpp"
+#include "gtx/simd_vec4.hpp"
+#endif
+
+//A 4x4 matrix for composing chains of transforms (e.g. the camera): converted once, multiplied as often as needed and
+//converted back. Only passed by reference since SSE types can't be passed by value on 32-bit Windows.
+class SimdMatrix {
+	private:
+#if defined(HORSE_SIMD_MATRICES)
+		typedef glm::simdMat4 MatrixType;
+#else
+		typedef glm::mat4 MatrixType;
+#endif
+		MatrixType matrix;
+	public:
+		SimdMatrix();
+		SimdMatrix(const glm::mat4 &matrixParam);
+		SimdMatrix operator*(const SimdMatrix &other) const;
+		glm::mat4 toMat4() const;
+
+		static const char* getBackendName();
+};
+
+//The conversions and the product are defined here so they inline into the caller: out of line, the call and the copies
+//cost more than the product itself.
+inline SimdMatrix::SimdMatrix()
+{
+	matrix = MatrixType(glm::mat4(1.0f));
+}
+
+inline SimdMatrix::SimdMatrix(const glm::mat4 &matrixParam)
+{
+	matrix = MatrixType(matrixParam);
+}
+
+inline SimdMatrix SimdMatrix::operator*(const SimdMatrix &other) const
+{
+	SimdMatrix product(*this);
+	product.matrix = matrix * other.matrix;
+	return product;
+}
+
+inline glm::mat4 SimdMatrix::toMat4() const
+{
+#if defined(HORSE_SIMD_MATRICES)
+	return glm::mat4_cast(matrix);
+#else
+	return matrix;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include <math.h>           //For sqrt() function.
+#include "Simulation.h"
+#include "Profiler.h"
+#include "CounterRandom.h"
+
+//Every random number of the simulation is keyed by the seed, so a given seed always produces the same herd and the same
+//behaviour.
+Simulation::Simulation(unsigned int seed)
+{
+	jobs = new JobSystem(0);    //Everything runs on the calling thread until a job system with workers is set.
+	herd = new HorseHerd();
+	herd->randomSeed = seed;
+	randomDraws = 0;
+	neighbourList = new NeighbourList(FIELD_HALF_SIZE, NEIGHBOUR_SKIN);
+	contactTable = new ContactTable();
+	spawnPlacer = new SpawnPlacer(FIELD_HALF_SIZE);
+}
+
+//Generate horses in random positions without causing collisions from the start. A horse that doesn't find a free spot
+//within MAX_SPAWN_ATTEMPTS looks for one right next to the horses placed so far. If that fails too, or the horse no
+//longer fits on the field at all, it stays where its last attempt put it (see getOverlappingSpawnQuantity()).
+void Simulation::spawnHorses(int quantity)
+{
+	for (int i = 0; i < quantity; i++) {
+		Horse* horse = new Horse(herd, getHorseQuantity() + 1);
+		horses.push_back(horse);
+		contactTable->setHorseQuantity(getHorseQuantity());
+		int attempts = 0;
+		bool isFree = spawnPlacer->isFree(horse->getPosition().x, horse->getPosition().z, horse->getCollisionRadius());
+		while (!isFree && attempts < MAX_SPAWN_ATTEMPTS && !spawnPlacer->isFull(horse->getCollisionRadius())) {
+			horse->randomizePosition();
+			attempts++;
+			isFree = spawnPlacer->isFree(horse->getPosition().x, horse->getPosition().z, horse->getCollisionRadius());
+		}
+		float x, z;
+		if (!isFree && !spawnPlacer->isFull(horse->getCollisionRadius())
+			&& spawnPlacer->findSpotNextToPlaced(horse->getCollisionRadius(), herd->randomSeed, SPAWN_STREAM, x, z)) {
+			horse->setPosition(x, z);
+			isFree = true;
+		}
+		spawnPlacer->place(horse->getPosition().x, horse->getPosition().z, horse->getCollisionRadius(), isFree);
+	}
+}
+
+//Check every pair of horses for collisions and update their collision status.
+void Simulation::resolveCollisions()
+{
+	PROFILE_ZONE("Resolve collisions");
+
+	//A new tick starts here, every random stream starts over at its first draw.
+	herd->tick++;
+	randomDraws = 0;
+
+	int rangeQuantity = (getHorseQuantity() + HORSES_PER_TASK - 1) / HORSES_PER_TASK;
+	if (rangeCollidedPairs.size() < rangeQuantity)
+		rangeCollidedPairs.resize(rangeQuantity);
+
+	//Broadphase: every horse's neighbour list holds the horses its forecast could reach. The lists are only built again
+	//(from a grid of the forecasted positions, one range of horses per task) once a forecast moved too far for them.
+	jobs->parallelFor(getHorseQuantity(), HORSES_PER_TASK, [this](int begin, int end) {
+		herd->updateHeadings(begin, end);
+	});
+	if (neighbourList->needsRebuild(herd->forecastedPosX, herd->forecastedPosZ, getHorseQuantity())) {
+		PROFILE_ZONE("Rebuild neighbour lists");
+		neighbourList->beginRebuild(herd->forecastedPosX, herd->forecastedPosZ, getHorseQuantity(), herd->getLargestCollisionRadius(), HORSES_PER_TASK);
+		jobs->parallelFor(getHorseQuantity(), HORSES_PER_TASK, [this](int begin, int end) {
+			neighbourList->rebuildRange(begin, end, herd->forecastedPosX, herd->forecastedPosZ, herd->collisionRadius);
+		});
+	}
+
+	//Narrowphase: keep the neighbours that actually collide (reads the forecasts and radii by index, no horse objects
+	//involved). Every range of horses is tested on its own, then the ranges are put back together in order so the
+	//collided pairs come out exactly as if the whole herd was done at once.
+	jobs->parallelFor(getHorseQuantity(), HORSES_PER_TASK, [this](int begin, int end) {
+		vector<pair<int, int> > &rangePairs = rangeCollidedPairs[begin / HORSES_PER_TASK];
+		rangePairs.clear();
+		for (int i = begin; i < end; i++) {
+			const int* neighbours = neighbourList->getNeighbours(i);
+			int neighbourQuantity = neighbourList->getNeighbourQuantity(i);
+			for (int k = 0; k < neighbourQuantity; k++)
+				if (forecastsCollide(i, neighbours[k]))
+					rangePairs.push_back(make_pair(i, neighbours[k]));
+		}
+	});
+	collidedPairs.clear();
+	for (int i = 0; i < rangeQuantity; i++)
+		collidedPairs.insert(collidedPairs.end(), rangeCollidedPairs[i].begin(), rangeCollidedPairs[i].end());
+
+	//Horses without any collision go back to normal (pairs too far apart to be checked would have done this).
+	for (int i = 0; i < getHorseQuantity(); i++)
+		releaseIfCollisionFree(horses.at(i));
+
+	//Contact bookkeeping. Only pairs that are collided now or were collided last frame produce an event.
+	contactTable->update(collidedPairs, contactEvents);
+	for (int i = 0; i < contactEvents.size(); i++) {
+		if (contactEvents[i].type == contactEnd)
+			collisionResolutionEnd(horses.at(contactEvents[i].horse1), horses.at(contactEvents[i].horse2));
+		else if (contactEvents[i].type == contactBegin)
+			contactTable->addContact(contactEvents[i].horse1, contactEvents[i].horse2);
+	}
+
+	//Collision resolution during the collision. Proposing only reads the horses, so the events can be split over threads;
+	//the random choices are drawn here up front (one per event) so the result is the same for any number of threads.
+	eventRandomBits.resize(contactEvents.size());
+	if (!contactEvents.empty())
+		CounterRandom::fillUniformInts(herd->randomSeed, SIMULATION_STREAM, herd->tick, randomDraws, contactEvents.size(), 0, 1, &eventRandomBits[0]);
+	randomDraws += contactEvents.size();
+	proposals.resize(contactEvents.size() * PROPOSALS_PER_EVENT);
+	jobs->parallelFor(contactEvents.size(), EVENTS_PER_TASK, [this](int begin, int end) {
+		for (int i = begin; i < end; i++)
+			proposeCollisionResolution(i, &proposals[i * PROPOSALS_PER_EVENT]);
+	});
+	groupProposalsByHorse();
+	jobs->parallelFor(getHorseQuantity(), HORSES_PER_TASK, [this](int begin, int end) {
+		for (int i = begin; i < end; i++)
+			applyCollisionProposals(i);
+	});
+
+	//Reset various properties to allow collision detection to resume as normal next frame.
+	for (int i = 0; i < getHorseQuantity() - 1; i++) {
+		//If two horses collided with each other and are in a stopped state, allow one of them to avoid so they aren't permanently stuck.
+		if (horses.at(i)->getCollisionStatus() != normal && contactTable->getContactQuantity(i) > 0) {
+			Horse* currentHorse = horses.at(i);
+			Horse* otherHorse = horses.at(contactTable->getOldestContact(i));
+			if (horses.at(i)->getCollisionStatus() == stopped && otherHorse->getCollisionStatus() == stopped) {
+				randomNumber(0, 1) == 0 ? currentHorse->setCollisionStatus(avoiding) : otherHorse->setCollisionStatus(avoiding);
+			}
+		}
+		if (horses.at(i)->getDirectionAssigned() == true) //Ensure that an avoiding horse is not stuck with left or right in subsequent
+			horses.at(i)->setDirectionAssigned(false);    //collision checks.
+	}
+}
+
+//Updates position and animation of horse. Ranges of horses are handled in parallel, each range is animated and then
+//moves on to its behaviour (a horse's behaviour only depends on its own animation).
+void Simulation::updatePositions()
+{
+	PROFILE_ZONE("Update positions");
+
+	jobs->parallelFor(getHorseQuantity(), HORSES_PER_TASK, [this](int begin, int end) {
+		for (int i = begin; i < end; i++)
+			horses[i]->animate();
+		for (int i = begin; i < end; i++)
+			horses[i]->updateBehaviour();
+	});
+
+	herd->integrate();
+}
+
+//Advance the herd by one frame.
+void Simulation::step()
+{
+	resolveCollisions();
+	updatePositions();
+}
+
+//GETTERS
+Horse* Simulation::getHorse(int i)
+{
+	return horses.at(i);
+}
+
+int Simulation::getHorseQuantity()
+{
+	return horses.size();
+}
+
+JobSystem* Simulation::getJobSystem()
+{
+	return jobs;
+}
+
+//Horses that were spawned on top of other horses because no free spot was found (the herd is too dense for the field).
+int Simulation::getOverlappingSpawnQuantity()
+{
+	return spawnPlacer->getOverlappingQuantity();
+}
+
+//How many times the neighbour lists had to be built (see NeighbourList).
+int Simulation::getNeighbourListRebuildQuantity()
+{
+	return neighbourList->getRebuildQuantity();
+}
+
+//Fraction of the field covered by the collision circles of every spawned horse.
+float Simulation::getSpawnCoveredFraction()
+{
+	return spawnPlacer->getCoveredFraction();
+}
+
+//SETTERS
+//The job system is shared with whoever else uses it (e.g. the pose evaluator) and isn't deleted by the simulation.
+void Simulation::setJobSystem(JobSystem* jobsParam)
+{
+	jobs = jobsParam;
+}
+
+//Every horse is turned with the whole field, so the rotation is kept once in the herd.
+void Simulation::setWorldRotation(glm::mat4 &worldRotationParam)
+{
+	const float* worldRotationValues = glm::value_ptr(worldRotationParam);
+	for (int i = 0; i < 16; i++)
+		herd->worldRotation[i] = worldRotationValues[i];
+}
+
+//Generates random integer from min to max (the next draw of the simulation's own stream this tick).
+int Simulation::randomNumber(int min, int max)
+{
+	return CounterRandom::uniformInt(herd->randomSeed, SIMULATION_STREAM, herd->tick, randomDraws++, min, max);
+}
+
+//Used for ongoing collisions.
+float Simulation::distanceBetweenTwoPoints(float x1, float x2, float y1, float y2, float z1, float z2) {
+	return sqrt((x2 - x1)*(x2 - x1) + (y2 - y1)*(y2 - y1) + (z2 - z1)*(z2 - z1));
+}
+
+//Basic collision detection where if a horse's sphere is in another, they are collided.
+//Verified by checking if distance is smaller than the sum of the radii of each horse.
+bool Simulation::sphereCollisionDetection(glm::vec3 pos1, glm::vec3 pos2, float radius1, float radius2)
+{
+	float distance = sqrt((pos2.x - pos1.x)*(pos2.x - pos1.x)
+		+ (pos2.y - pos2.y)*(pos2.y - pos2.y)
+		+ (pos2.z - pos1.z)*(pos2.z - pos1.z));
+	if (distance <= radius1 + radius2)
+		return true;
+	else
+		return false;
+}
+
+//Check if two horses would collide with each other in the next frame.
+bool Simulation::collisionDetected(Horse* horse1, Horse* horse2, forecastDirection direction)
+{
+	glm::vec3 horseVec1 = horse1->getForecastedPosition(direction);
+	glm::vec3 horseVec2 = horse2->getForecastedPosition(direction);
+	float horseRadius1 = horse1->getCollisionRadius();
+	float horseRadius2 = horse2->getCollisionRadius();
+	return sphereCollisionDetection(horseVec1, horseVec2, horseRadius1, horseRadius2);
+}
+
+//Same test as collisionDetected() going straight, on the forecasts computed for the whole herd this frame.
+bool Simulation::forecastsCollide(int i, int j)
+{
+	float distance = sqrt((herd->forecastedPosX[j] - herd->forecastedPosX[i])*(herd->forecastedPosX[j] - herd->forecastedPosX[i])
+		+ (herd->forecastedPosZ[j] - herd->forecastedPosZ[i])*(herd->forecastedPosZ[j] - herd->forecastedPosZ[i]));
+	return distance <= herd->collisionRadius[i] + herd->collisionRadius[j];
+}
+
+//Checks if a controlled horse and an independent horse would collide with each other in the next frame.
+bool Simulation::collisionDetectedWithControlledHorse(Horse* controlledHorse, Horse* independentHorse)
+{
+	glm::vec3 horseVecControlled = controlledHorse->getForecastedPosition(straightDir);
+	glm::vec3 horseVecIndependent = independentHorse->getForecastedPosition(noDir);
+	float horseRadiusControlled = controlledHorse->getCollisionRadius();
+	float horseRadiusIndependent = independentHorse->getCollisionRadius();
+	return sphereCollisionDetection(horseVecControlled, horseVecIndependent, horseRadiusControlled, horseRadiusIndependent);
+}
+
+//Checks if horses are farther away from each other if the avoided horse goes straight.
+//This is done by checking if the distance calculated with no horse movement is smaller than the distance
+//calculated accounting for if the avoiding horse moves straight next frame
+bool Simulation::isFartherFromCollision(Horse* stoppedHorse, Horse* avoidingHorse, forecastDirection direction)
+{
+	glm::vec3 horseVecStopped = stoppedHorse->getForecastedPosition(noDir);
+	glm::vec3 horseVecAvoidingBefore = avoidingHorse->getForecastedPosition(noDir);
+	glm::vec3 horseVecAvoidingAfter = avoidingHorse->getForecastedPosition(direction);
+	float distanceBefore = distanceBetweenTwoPoints(horseVecStopped.x, horseVecAvoidingBefore.x, horseVecStopped.y, horseVecAvoidingBefore.y, horseVecStopped.z, horseVecAvoidingBefore.z);
+	float distanceAfter = distanceBetweenTwoPoints(horseVecStopped.x, horseVecAvoidingAfter.x, horseVecStopped.y, horseVecAvoidingAfter.y, horseVecStopped.z, horseVecAvoidingAfter.z);
+	if (distanceBefore <= distanceAfter)
+		return true;
+	else
+		return false;
+}
+
+//Check if a horse is going out of bounds.
+bool Simulation::goingOutOfBounds(Horse* avoidingHorse)
+{
+	glm::vec3 horseVec = avoidingHorse->getForecastedPosition(straightDir);
+	if ((horseVec.x >= -50.0f && horseVec.x <= 50.0f) && (horseVec.z >= -50.0f && horseVec.z <= 50.0f))
+		return false;
+	else
+		return true;
+}
+
+//Works out what a contact event changes about its horses, as proposals (nothing is changed here, so every event sees the
+//horses as they were before resolution). Accounts for the following scenarios:
+//- Two normal horses collided.
+//- A normal horse and a collided horse collide.
+//- If two avoiding horses collide.
+//- Collision of independent horse and controlled horse.
+//- Collision of an avoiding horse and a stopped horse.
+void Simulation::proposeCollisionResolution(int event, CollisionProposal* eventProposals) {
+	for (int i = 0; i < PROPOSALS_PER_EVENT; i++)
+		eventProposals[i].type = noProposal;
+	if (contactEvents[event].type == contactEnd)
+		return;
+
+	Horse* horse1 = horses.at(contactEvents[event].horse1);
+	Horse* horse2 = horses.at(contactEvents[event].horse2);
+	int randomBit = eventRandomBits[event];
+	//Two normal horses or two avoiding horses: Set one to avoid and the other to stop.
+	if ((horse1->getCollisionStatus() == normal && horse2->getCollisionStatus() == normal)
+		|| (horse1->getCollisionStatus() == avoiding && horse2->getCollisionStatus() == avoiding)) {
+		CollisionProposal proposal1 = { horse1->getId() - 1, statusProposal, randomBit == 0 ? stopped : avoiding };
+		CollisionProposal proposal2 = { horse2->getId() - 1, statusProposal, randomBit == 0 ? avoiding : stopped };
+		eventProposals[0] = proposal1;
+		eventProposals[1] = proposal2;
+	}
+	//A normal horse and a collided horse: Set the normal horse to stop.
+	else if (horse1->getCollisionStatus() == normal || horse2->getCollisionStatus() == normal) {
+		Horse* normalHorse = horse1->getCollisionStatus() == normal ? horse1 : horse2;
+		CollisionProposal proposal = { normalHorse->getId() - 1, statusProposal, stopped };
+		eventProposals[0] = proposal;
+	}
+	//Scenario when one horse is controlled by the user. Independent horse starts avoiding in this type of collision.
+	else if (horse1->getCollisionStatus() == controlled || horse2->getCollisionStatus() == controlled) {
+		Horse* controlledHorse;
+		Horse* independentHorse;
+		horse1->getCollisionStatus() == controlled ?
+			(controlledHorse = horse1, independentHorse = horse2) :
+			(controlledHorse = horse2, independentHorse = horse1);
+		forecastDirection direction = independentHorse->getAvoidingDirection();
+		//Avoiding horse should go straight if:
+		//- It goes farther from the collision
+		//- It doesn't go out of bounds
+		//- Previous collision checks for the avoiding horse doesn't tell it to go left or right.
+		if (isFartherFromCollision(controlledHorse, independentHorse, straightDir)
+			&& !goingOutOfBounds(independentHorse)
+			&& (independentHorse->getDirectionAssigned() == false || (independentHorse->getDirectionAssigned() == true && independentHorse->getAvoidingDirection() == straightDir)))
+			direction = straightDir;
+		//Avoiding horse randomly decide to go left or right if not already assigned a direction (so horse doesn't alternate between left and right randomly).
+		else if (direction != leftDir && direction != rightDir) {
+			if (randomBit == 0)
+				direction = isFartherFromCollision(independentHorse, independentHorse, leftDir) ? leftDir : rightDir;
+			else
+				direction = isFartherFromCollision(independentHorse, independentHorse, rightDir) ? rightDir : leftDir;
+		}
+		CollisionProposal statusChange = { independentHorse->getId() - 1, statusProposal, avoiding };
+		CollisionProposal directionChange = { independentHorse->getId() - 1, directionProposal, direction };
+		eventProposals[0] = statusChange;
+		eventProposals[1] = directionChange;
+	}
+	else {
+		Horse* stoppedHorse;
+		Horse* avoidingHorse;
+		horse1->getCollisionStatus() == stopped ?
+			(stoppedHorse = horse1, avoidingHorse = horse2) :
+			(stoppedHorse = horse2, avoidingHorse = horse1);
+		forecastDirection direction = avoidingHorse->getAvoidingDirection();
+		//Avoiding horse should go straight if:
+		//- It goes farther from the collision
+		//- It doesn't go out of bounds
+		//- Previous collision checks for the avoiding horse doesn't tell it to go left or right.
+		if (isFartherFromCollision(stoppedHorse, avoidingHorse, straightDir)
+			&& !goingOutOfBounds(avoidingHorse)
+			&& (avoidingHorse->getDirectionAssigned() == false || (avoidingHorse->getDirectionAssigned() == true && avoidingHorse->getAvoidingDirection() == straightDir)))
+			direction = straightDir;
+		//Avoiding horse randomly decides to go left or right if not already assigned a direction (so horse doesn't alternate between left and right randomly).
+		else if (direction != leftDir && direction != rightDir) {
+			if (randomBit == 0)
+				direction = isFartherFromCollision(stoppedHorse, avoidingHorse, leftDir) ? leftDir : rightDir;
+			else
+				direction = isFartherFromCollision(stoppedHorse, avoidingHorse, rightDir) ? rightDir : leftDir;
+		}
+		CollisionProposal directionChange = { avoidingHorse->getId() - 1, directionProposal, direction };
+		eventProposals[0] = directionChange;
+		//If a horse has turned 360 degrees (in general, not entirely left or right), we assume it's trapped and set it free.
+		//We do this by giving a horse that is collided with the avoiding horse avoiding behaviour while the other horse gets stopped
+		//behaviour. The one who collided with the avoided horse first gets avoid behaviour.
+		if (avoidingHorse->isTrapped()) {
+			CollisionProposal trapped = { avoidingHorse->getId() - 1, trappedProposal, stopped };
+			eventProposals[1] = trapped;
+			int newAvoidingHorse = contactTable->getOldestContact(avoidingHorse->getId() - 1);
+			if (newAvoidingHorse != -1) {
+				CollisionProposal escape = { newAvoidingHorse, escapeProposal, avoiding };
+				eventProposals[2] = escape;
+			}
+		}
+	}
+}
+
+//Sorts the proposals by the horse they are for (a counting sort, so each horse's proposals stay in event order).
+void Simulation::groupProposalsByHorse() {
+	horseProposalStart.assign(getHorseQuantity() + 1, 0);
+	for (int i = 0; i < proposals.size(); i++)
+		if (proposals[i].type != noProposal)
+			horseProposalStart[proposals[i].horse + 1]++;
+	for (int i = 0; i < getHorseQuantity(); i++)
+		horseProposalStart[i + 1] += horseProposalStart[i];
+	horseProposals.resize(horseProposalStart[getHorseQuantity()]);
+	for (int i = 0; i < proposals.size(); i++)
+		if (proposals[i].type != noProposal)
+			horseProposals[horseProposalStart[proposals[i].horse]++] = i;
+	//Filling in moved every start up to the next horse's start, so shift them back.
+	for (int i = getHorseQuantity(); i > 0; i--)
+		horseProposalStart[i] = horseProposalStart[i - 1];
+	horseProposalStart[0] = 0;
+}
+
+//Reduces the proposals for a horse to one change and applies it. Only this horse is written to, so horses can be done on
+//any thread. The reduction only depends on the order of the events:
+//- Being trapped wins over everything else, then taking over from a trapped horse, then the first status proposed.
+//- The horse avoids in the first left or right direction proposed, or straight if every contact agrees on straight.
+void Simulation::applyCollisionProposals(int horse) {
+	if (horseProposalStart[horse] == horseProposalStart[horse + 1])
+		return;
+
+	bool isTrapped = false;
+	bool isEscaping = false;
+	int newStatus = -1;
+	int newDirection = -1;
+	for (int i = horseProposalStart[horse]; i < horseProposalStart[horse + 1]; i++) {
+		CollisionProposal &proposal = proposals[horseProposals[i]];
+		if (proposal.type == trappedProposal)
+			isTrapped = true;
+		else if (proposal.type == escapeProposal)
+			isEscaping = true;
+		else if (proposal.type == statusProposal && newStatus == -1)
+			newStatus = proposal.value;
+		else if (proposal.type == directionProposal && newDirection != leftDir && newDirection != rightDir)
+			newDirection = proposal.value;
+	}
+
+	Horse* currentHorse = horses.at(horse);
+	if (isTrapped) {
+		currentHorse->releaseFromTrap();
+		return;
+	}
+	if (isEscaping)
+		currentHorse->setCollisionStatus(avoiding);
+	else if (newStatus != -1)
+		currentHorse->setCollisionStatus((status)newStatus);
+	if (newDirection != -1) {
+		currentHorse->setAvoidingDirection((forecastDirection)newDirection);
+		currentHorse->setDirectionAssigned(true);
+	}
+}
+
+//Update collision properties for the horses if they are just getting out of a collision.
+void Simulation::collisionResolutionEnd(Horse* horse1, Horse* horse2) {
+	contactTable->removeContact(horse1->getId() - 1, horse2->getId() - 1);
+	releaseIfCollisionFree(horse1);
+	releaseIfCollisionFree(horse2);
+}
+
+//A horse that isn't collided with any other horse goes back to its normal behaviour.
+void Simulation::releaseIfCollisionFree(Horse* horse) {
+	if (contactTable->getContactQuantity(horse->getId() - 1) == 0) {
+		horse->setCollisionStatus(normal);
+		if (horse->getAvoidingDirection() != noDir)
+			horse->setAvoidingDirection(noDir);
+	}
+}
\ No newline at end of file
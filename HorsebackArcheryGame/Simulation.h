@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include "Horse.h"
+#include "NeighbourList.h"
+#include "ContactTable.h"
+#include "JobSystem.h"
+#include "SpawnPlacer.h"
+
+using namespace std;
+
+//What a contact wants to change about one of its horses.
+//- statusProposal: Take on the status in value.
+//- directionProposal: Avoid in the direction in value.
+//- trappedProposal: The horse turned all the way around while avoiding, so it stops and forgets its direction.
+//- escapeProposal: The horse takes over avoiding from a trapped horse (wins over statusProposal).
+enum proposalType { noProposal, statusProposal, directionProposal, trappedProposal, escapeProposal };
+
+struct CollisionProposal {
+	int horse;
+	proposalType type;
+	int value;
+};
+
+//Everything needed to advance the herd one frame at a time without a window or a GL context (the game loop and the
+//command-line runner both drive this).
+class Simulation {
+	private:
+		const int MAX_SPAWN_ATTEMPTS = 1000;  //Give up looking for a free spot after this many tries (the field can't fit every herd size).
+		const float FIELD_HALF_SIZE = 50.0f;  //Horses stay within -50 to 50 on both the x-axis and the z-axis.
+		const int HORSES_PER_TASK = 256;      //Horses handled by one task when work is split over threads (a multiple of 8, see HorseHerd).
+		const int EVENTS_PER_TASK = 512;      //Contact events handled by one task when proposing collision resolutions.
+		const int PROPOSALS_PER_EVENT = 3;    //Most changes one contact can propose (two horses plus the one taking over from a trapped horse).
+		const unsigned int SIMULATION_STREAM = 0;  //Random stream of the simulation itself (horses use their ids, which start at 1).
+		const unsigned int SPAWN_STREAM = 0xFFFFFFFF;  //Random stream of the spots tried next to placed horses (past any horse id).
+		const float NEIGHBOUR_SKIN = 8.0f;    //Reach of the neighbour lists beyond the collision radii (a few frames at MAX_SPEED, see NeighbourList).
+
+		unsigned int randomDraws;             //Numbers drawn from the simulation's stream this tick.
+
+		JobSystem* jobs;                      //Threads the per-horse work is spread over.
+
+		HorseHerd* herd;                      //Per-frame state of every horse, stored field by field.
+		vector<Horse*> horses;                //All horses that exist in the scene (each one refers to its slot in the herd).
+
+		//Broadphase for collision detection (reused every frame to avoid reallocating).
+		NeighbourList* neighbourList;                          //Pairs close enough to possibly collide, per range of HORSES_PER_TASK horses.
+		vector<vector<pair<int, int> > > rangeCollidedPairs;   //Pairs of each range that collide this frame.
+		vector<pair<int, int> > collidedPairs;                 //Pairs that collide this frame, all ranges in order.
+
+		SpawnPlacer* spawnPlacer;                //Free spots for new horses.
+		ContactTable* contactTable;              //Which horses are collided with which (replaces a collision list per horse).
+		vector<ContactEvent> contactEvents;
+
+		//Collision resolution works in three phases so contacts can be split over threads: every contact proposes changes
+		//from the statuses as they were before resolution (read only), the proposals of each horse are reduced in event
+		//order, and every horse applies its own result.
+		vector<int> eventRandomBits;               //One per event, drawn before proposing.
+		vector<CollisionProposal> proposals;       //PROPOSALS_PER_EVENT slots per event.
+		vector<int> horseProposalStart;            //Per horse: where its proposals start in horseProposals...
+		vector<int> horseProposals;                //...which lists proposals by horse, in event order within each horse.
+
+		int randomNumber(int min, int max);
+		float distanceBetweenTwoPoints(float x1, float x2, float y1, float y2, float z1, float z2);
+		bool sphereCollisionDetection(glm::vec3 pos1, glm::vec3 pos2, float radius1, float radius2);
+		bool collisionDetected(Horse* horse1, Horse* horse2, forecastDirection direction);
+		bool forecastsCollide(int i, int j);
+		bool isFartherFromCollision(Horse* stoppedHorse, Horse* avoidingHorse, forecastDirection direction);
+		bool goingOutOfBounds(Horse* avoidingHorse);
+		void proposeCollisionResolution(int event, CollisionProposal* eventProposals);
+		void groupProposalsByHorse();
+		void applyCollisionProposals(int horse);
+		void collisionResolutionEnd(Horse* horse1, Horse* horse2);
+		void releaseIfCollisionFree(Horse* horse);
+	public:
+		Simulation(unsigned int seed);
+		void spawnHorses(int quantity);
+		void resolveCollisions();
+		void updatePositions();
+		void step();
+
+		//GETTERS
+		Horse* getHorse(int i);
+		int getHorseQuantity();
+		JobSystem* getJobSystem();
+		int getOverlappingSpawnQuantity();
+		int getNeighbourListRebuildQuantity();
+		float getSpawnCoveredFraction();
+
+		//SETTERS
+		void setJobSystem(JobSystem* jobsParam);
+		void setWorldRotation(glm::mat4 &worldRotationParam);
+
+		bool collisionDetectedWithControlledHorse(Horse* controlledHorse, Horse* independentHorse);
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid(float fieldHalfSizeParam)
+{
+	fieldHalfSize = fieldHalfSizeParam;
+	cellSize = 2 * fieldHalfSize;
+	cellsPerSide = 1;
+}
+
+//Cell along one axis. Positions slightly out of bounds (i.e. forecasted positions) are kept in the border cells.
+int SpatialGrid::getCellCoordinate(float position)
+{
+	int cell = (int)((position + fieldHalfSize) / cellSize);
+	if (cell < 0)
+		cell = 0;
+	else if (cell >= cellsPerSide)
+		cell = cellsPerSide - 1;
+	return cell;
+}
+
+//Sort every horse into its cell (counting sort, so the horses of a cell stay in ascending order).
+void SpatialGrid::rebuild(const float* positionsX, const float* positionsZ, int entryQuantity, float minimumCellSize)
+{
+	cellsPerSide = 1;
+	if (minimumCellSize > 0.0f)
+		cellsPerSide = max(1, (int)(2 * fieldHalfSize / minimumCellSize));
+	cellSize = 2 * fieldHalfSize / cellsPerSide;
+
+	cellStart.assign(cellsPerSide*cellsPerSide + 1, 0);
+	cellEntries.resize(entryQuantity);
+	entryCellX.resize(entryQuantity);
+	entryCellZ.resize(entryQuantity);
+
+	//Count the horses of each cell...
+	for (int i = 0; i < entryQuantity; i++) {
+		entryCellX[i] = getCellCoordinate(positionsX[i]);
+		entryCellZ[i] = getCellCoordinate(positionsZ[i]);
+		cellStart[entryCellZ[i] * cellsPerSide + entryCellX[i] + 1]++;
+	}
+	//...turn the counts into starting points...
+	for (int i = 1; i <= cellsPerSide*cellsPerSide; i++)
+		cellStart[i] += cellStart[i - 1];
+	//...and place every horse after the ones already in its cell.
+	for (int i = 0; i < entryQuantity; i++) {
+		int cell = entryCellZ[i] * cellsPerSide + entryCellX[i];
+		cellEntries[cellStart[cell]++] = i;
+	}
+	//Placing the horses moved every starting point to the start of the next cell, so shift them back.
+	for (int i = cellsPerSide*cellsPerSide; i > 0; i--)
+		cellStart[i] = cellStart[i - 1];
+	cellStart[0] = 0;
+}
+
+//Every pair of horses in the same or neighbouring cells, each pair once (smaller index first) in ascending order.
+//The order matches going through every pair with a nested loop, so collision resolution stays deterministic.
+void SpatialGrid::findCandidatePairs(vector<pair<int, int> > &pairs)
+{
+	findCandidatePairs(0, entryCellX.size(), pairs);
+}
+
+//Only the pairs whose first horse is from begin to end. The grid isn't changed, so different ranges can be searched on
+//different threads, and putting the ranges one after the other gives the same pairs in the same order as the whole search.
+void SpatialGrid::findCandidatePairs(int begin, int end, vector<pair<int, int> > &pairs)
+{
+	pairs.clear();
+	for (int i = begin; i < end; i++) {
+		int firstPair = pairs.size();
+		for (int cellZ = max(0, entryCellZ[i] - 1); cellZ <= min(cellsPerSide - 1, entryCellZ[i] + 1); cellZ++)
+			for (int cellX = max(0, entryCellX[i] - 1); cellX <= min(cellsPerSide - 1, entryCellX[i] + 1); cellX++) {
+				int cell = cellZ * cellsPerSide + cellX;
+				for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+					if (cellEntries[k] > i)
+						pairs.push_back(make_pair(i, cellEntries[k]));
+			}
+		sort(pairs.begin() + firstPair, pairs.end());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+//Uniform grid laid over the square field. Every horse is sorted into the cell its position falls in so that only horses
+//in neighbouring cells need to be tested against each other (cells are at least as wide as the largest collision diameter).
+class SpatialGrid {
+	private:
+		float fieldHalfSize;         //Grid covers -fieldHalfSize to fieldHalfSize on both the x-axis and the z-axis.
+		float cellSize;
+		int cellsPerSide;
+		vector<int> cellStart;       //Where each cell's horses start in cellEntries (one extra entry marks the end of the last cell).
+		vector<int> cellEntries;     //Horse indices sorted by cell, ascending within each cell.
+		vector<int> entryCellX;      //Cell of each horse.
+		vector<int> entryCellZ;
+
+		int getCellCoordinate(float position);
+	public:
+		SpatialGrid(float fieldHalfSizeParam);
+		void rebuild(const float* positionsX, const float* positionsZ, int entryQuantity, float minimumCellSize);
+		void findCandidatePairs(vector<pair<int, int> > &pairs);
+		void findCandidatePairs(int begin, int end, vector<pair<int, int> > &pairs);
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <math.h>           //For cos() and sin().
+#include "SpawnPlacer.h"
+#include "CounterRandom.h"
+
+const float SpawnPlacer::DENSEST_PACKING = 0.9069f;   //pi / (2 * sqrt(3)), discs in a hexagonal lattice.
+
+SpawnPlacer::SpawnPlacer(float fieldHalfSizeParam)
+{
+	fieldHalfSize = fieldHalfSizeParam;
+	clear();
+}
+
+//Forget every placed horse.
+void SpawnPlacer::clear()
+{
+	cellSize = 2 * fieldHalfSize;
+	cellsPerSide = 1;
+	firstInCell.assign(1, -1);
+	nextInCell.clear();
+	placedX.clear();
+	placedZ.clear();
+	placedRadius.clear();
+	noRoomRadius.clear();
+	largestRadius = 0.0f;
+	coveredArea = 0.0f;
+	overlappingQuantity = 0;
+}
+
+//Cell along one axis. Positions out of bounds are kept in the border cells.
+int SpawnPlacer::getCellCoordinate(float position)
+{
+	int cell = (int)((position + fieldHalfSize) / cellSize);
+	if (cell < 0)
+		cell = 0;
+	else if (cell >= cellsPerSide)
+		cell = cellsPerSide - 1;
+	return cell;
+}
+
+void SpawnPlacer::insert(int placed)
+{
+	int cell = getCellCoordinate(placedZ[placed]) * cellsPerSide + getCellCoordinate(placedX[placed]);
+	nextInCell[placed] = firstInCell[cell];
+	firstInCell[cell] = placed;
+}
+
+//Resize the cells and sort every placed horse into them again (only happens when a horse larger than every one before
+//it arrives, so a handful of times per herd).
+void SpawnPlacer::rebuild(float minimumCellSize)
+{
+	cellsPerSide = max(1, (int)(2 * fieldHalfSize / minimumCellSize));
+	cellSize = 2 * fieldHalfSize / cellsPerSide;
+	firstInCell.assign(cellsPerSide*cellsPerSide, -1);
+	for (int i = 0; i < placedX.size(); i++)
+		insert(i);
+}
+
+//Add a horse at a spot (isFreeSpot tells whether the spot was free or the horse had to go there anyway).
+void SpawnPlacer::place(float x, float z, float radius, bool isFreeSpot)
+{
+	placedX.push_back(x);
+	placedZ.push_back(z);
+	placedRadius.push_back(radius);
+	noRoomRadius.push_back(-1.0f);
+	nextInCell.push_back(-1);
+	coveredArea += 3.14159265f*radius*radius;
+	if (!isFreeSpot)
+		overlappingQuantity++;
+	largestRadius = max(largestRadius, radius);
+	if (placedX.size() == 1 || 2 * radius > cellSize)
+		rebuild(2 * largestRadius);   //The first horse sizes the cells, larger horses make them wider.
+	else
+		insert(placedX.size() - 1);
+}
+
+//Check if a horse of the given radius fits at a spot without touching any placed horse. Cells are at least as wide as
+//the largest diameter, so any horse close enough to touch is in the same or a neighbouring cell.
+bool SpawnPlacer::isFree(float x, float z, float radius)
+{
+	if (!placedX.empty() && 2 * radius > cellSize)
+		rebuild(2 * radius);
+	int centerX = getCellCoordinate(x);
+	int centerZ = getCellCoordinate(z);
+	for (int cellZ = max(0, centerZ - 1); cellZ <= min(cellsPerSide - 1, centerZ + 1); cellZ++)
+		for (int cellX = max(0, centerX - 1); cellX <= min(cellsPerSide - 1, centerX + 1); cellX++)
+			for (int i = firstInCell[cellZ * cellsPerSide + cellX]; i != -1; i = nextInCell[i]) {
+				float distanceSquared = (placedX[i] - x)*(placedX[i] - x) + (placedZ[i] - z)*(placedZ[i] - z);
+				float touchingDistance = placedRadius[i] + radius;
+				if (distanceSquared <= touchingDistance*touchingDistance)
+					return false;
+			}
+	return true;
+}
+
+//Look for a free spot for a horse of the given radius right next to a placed horse: for every placed horse that may still
+//have room for it, try SPOTS_PER_PLACED spots at random between touching that horse and one of the new horse's diameters
+//further out (Bridson's Poisson-disk sampling, with every placed horse as an active sample). A placed horse without room
+//for a radius is skipped for that radius and larger ones from then on. The spots are drawn from the given random stream
+//(one tick per placed horse count, so every call draws different spots). Returns false if no spot was found.
+bool SpawnPlacer::findSpotNextToPlaced(float radius, unsigned int seed, unsigned int stream, float &x, float &z)
+{
+	unsigned int tick = placedX.size();
+	unsigned int draw = 0;
+	for (int i = 0; i < placedX.size(); i++) {
+		if (noRoomRadius[i] >= 0.0f && radius >= noRoomRadius[i])
+			continue;
+		for (int spot = 0; spot < SPOTS_PER_PLACED; spot++) {
+			float angle = CounterRandom::uniformInt(seed, stream, tick, draw++, 0, 62831) / 10000.0f;
+			float distance = placedRadius[i] + radius + 1e-3f + CounterRandom::uniformInt(seed, stream, tick, draw++, 0, 1000) / 1000.0f * 2 * radius;
+			float spotX = placedX[i] + distance*cos(angle);
+			float spotZ = placedZ[i] + distance*sin(angle);
+			if (spotX < -fieldHalfSize || spotX > fieldHalfSize || spotZ < -fieldHalfSize || spotZ > fieldHalfSize)
+				continue;
+			if (isFree(spotX, spotZ, radius)) {
+				x = spotX;
+				z = spotZ;
+				return true;
+			}
+		}
+		noRoomRadius[i] = radius;
+	}
+	return false;
+}
+
+//Whether a horse of the given radius can't fit anymore however the placed horses were arranged: with it, the collision
+//circles would cover more of the field than discs can without overlapping. A horse that misses a free spot by chance
+//doesn't make the field full, every horse gets its own bounded search until the coverage says there is no room.
+bool SpawnPlacer::isFull(float radius)
+{
+	return coveredArea + 3.14159265f*radius*radius > DENSEST_PACKING * 4 * fieldHalfSize*fieldHalfSize;
+}
+
+//GETTERS
+int SpawnPlacer::getPlacedQuantity()
+{
+	return placedX.size();
+}
+
+int SpawnPlacer::getOverlappingQuantity()
+{
+	return overlappingQuantity;
+}
+
+//Fraction of the field covered by the horses' collision circles (overlapping horses included). Random spots stop finding
+//room at around 55% coverage whatever the number of attempts, and the spots next to placed horses only fit a few more.
+float SpawnPlacer::getCoveredFraction()
+{
+	return coveredArea / (4 * fieldHalfSize*fieldHalfSize);
+}
\ No newline at end of file
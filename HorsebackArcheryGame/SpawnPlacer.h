@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+//Finds room for newly spawned horses. Every horse placed so far is kept in a uniform grid (cells at least as wide as the
+//largest collision diameter), so checking a spot only looks at the horses in the neighbouring cells instead of the whole
+//herd, and spawning grows linearly with the herd. A spot is free if the new horse's collision sphere doesn't touch any
+//placed horse's (each horse with its own radius). Once random spots stop finding room, findSpotNextToPlaced() looks in
+//the gaps right next to the placed horses like Poisson-disk sampling's active list.
+class SpawnPlacer {
+	private:
+		float fieldHalfSize;            //Grid covers -fieldHalfSize to fieldHalfSize on both the x-axis and the z-axis.
+		float cellSize;
+		int cellsPerSide;
+		vector<int> firstInCell;        //Most recently placed horse of each cell (-1 if none)...
+		vector<int> nextInCell;         //...and the one placed before it in the same cell, per placed horse.
+		vector<float> placedX;
+		vector<float> placedZ;
+		vector<float> placedRadius;
+		float largestRadius;
+		float coveredArea;              //Sum of the areas of every placed horse's collision circle.
+		int overlappingQuantity;        //Horses that had to be placed without finding a free spot.
+		vector<float> noRoomRadius;     //Per placed horse: smallest radius no spot was found next to it for (-1 if none).
+
+		int getCellCoordinate(float position);
+		void insert(int placed);
+		void rebuild(float minimumCellSize);
+	public:
+		static const float DENSEST_PACKING;   //Largest fraction of a plane equal discs can cover without overlapping.
+		static const int SPOTS_PER_PLACED = 30;  //Spots tried next to a placed horse before it's taken to have no room left.
+
+		SpawnPlacer(float fieldHalfSizeParam);
+		void clear();
+		bool isFree(float x, float z, float radius);
+		bool findSpotNextToPlaced(float radius, unsigned int seed, unsigned int stream, float &x, float &z);
+		void place(float x, float z, float radius, bool isFreeSpot);
+		bool isFull(float radius);
+
+		//GETTERS
+		int getPlacedQuantity();
+		int getOverlappingQuantity();
+		float getCoveredFraction();
+};
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "TaskGraph.h"
+#include "Profiler.h"
+
+TaskGraph::TaskGraph()
+{
+	remainingDependencies = NULL;
+	remainingTasks = 0;
+}
+
+TaskGraph::~TaskGraph()
+{
+	delete[] remainingDependencies;
+}
+
+//Returns the task's index (used to add dependencies).
+int TaskGraph::addTask(const char* name, function<void()> work, bool isPinned)
+{
+	Task task;
+	task.name = name;
+	task.work = work;
+	task.isPinned = isPinned;
+	task.dependencyQuantity = 0;
+	tasks.push_back(task);
+	return tasks.size() - 1;
+}
+
+//The task after only starts once the task before is done.
+void TaskGraph::addDependency(int before, int after)
+{
+	tasks[before].successors.push_back(after);
+	tasks[after].dependencyQuantity++;
+}
+
+//Run every task once and return when all of them are done. The calling thread runs the pinned tasks and helps with the
+//others in between. With a NULL job system every task runs on the calling thread in an order that respects the dependencies.
+void TaskGraph::run(JobSystem* jobs)
+{
+	if (tasks.empty())
+		return;
+
+	delete[] remainingDependencies;
+	remainingDependencies = new atomic<int>[tasks.size()];
+	for (int i = 0; i < tasks.size(); i++)
+		remainingDependencies[i] = tasks[i].dependencyQuantity;
+	remainingTasks = tasks.size();
+
+	for (int i = 0; i < tasks.size(); i++)
+		if (tasks[i].dependencyQuantity == 0)
+			schedule(i, jobs);
+
+	while (remainingTasks > 0) {
+		int pinnedTask = -1;
+		{
+			lock_guard<mutex> guard(readyPinnedLock);
+			if (!readyPinnedTasks.empty()) {
+				pinnedTask = readyPinnedTasks.back();
+				readyPinnedTasks.pop_back();
+			}
+		}
+		if (pinnedTask >= 0)
+			runTask(pinnedTask, jobs);
+		else if (jobs != NULL)
+			jobs->helpUntil([this] { return isWaitOver(); });
+	}
+}
+
+//Whether the thread running the graph has something to do besides helping with the job system's jobs.
+bool TaskGraph::isWaitOver()
+{
+	lock_guard<mutex> guard(readyPinnedLock);
+	return remainingTasks == 0 || !readyPinnedTasks.empty();
+}
+
+void TaskGraph::clear()
+{
+	tasks.clear();
+}
+
+//Hand a task whose dependencies are done to whichever thread has to run it.
+void TaskGraph::schedule(int task, JobSystem* jobs)
+{
+	if (tasks[task].isPinned || jobs == NULL) {
+		{
+			lock_guard<mutex> guard(readyPinnedLock);
+			readyPinnedTasks.push_back(task);
+		}
+		if (jobs != NULL)
+			jobs->wakeWaiters();
+	}
+	else
+		jobs->submit([this, task, jobs] { runTask(task, jobs); });
+}
+
+void TaskGraph::runTask(int task, JobSystem* jobs)
+{
+	{
+		PROFILE_ZONE(tasks[task].name);
+		tasks[task].work();
+	}
+	for (int i = 0; i < tasks[task].successors.size(); i++) {
+		int successor = tasks[task].successors[i];
+		if (--remainingDependencies[successor] == 0)
+			schedule(successor, jobs);
+	}
+	if (--remainingTasks == 0 && jobs != NULL)
+		jobs->wakeWaiters();
+}
+
+//GETTERS
+int TaskGraph::getTaskQuantity()
+{
+	return tasks.size();
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include "JobSystem.h"
+
+using namespace std;
+
+//A set of tasks and the order some of them have to run in. Running the graph starts every task as soon as the tasks it
+//depends on are done, so independent tasks run at the same time on the job system's threads. Pinned tasks always run on
+//the thread that runs the graph, for work that has to stay on one thread (e.g. anything that needs the GL context).
+class TaskGraph {
+	private:
+		struct Task {
+			const char* name;            //Shown in the profiler, so it has to be a string literal.
+			function<void()> work;
+			bool isPinned;
+			vector<int> successors;      //Tasks that depend on this one.
+			int dependencyQuantity;
+		};
+
+		vector<Task> tasks;
+		atomic<int>* remainingDependencies;  //Per task, while the graph runs.
+		atomic<int> remainingTasks;
+
+		//Pinned tasks that are ready, waiting for the thread running the graph to pick them up.
+		mutex readyPinnedLock;
+		vector<int> readyPinnedTasks;
+
+		void schedule(int task, JobSystem* jobs);
+		void runTask(int task, JobSystem* jobs);
+		bool isWaitOver();
+	public:
+		TaskGraph();
+		~TaskGraph();
+		int addTask(const char* name, function<void()> work, bool isPinned);
+		void addDependency(int before, int after);
+		void run(JobSystem* jobs);
+		void clear();
+
+		//GETTERS
+		int getTaskQuantity();
+};
\ No newline at end of file
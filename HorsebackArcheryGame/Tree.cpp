@@ -1,51 +1,118 @@
+#include <math.h>           //For cos() and sin().
+#include <string.h>         //For memcmp().
 #include "Tree.h"
+#include "SimdMatrix.h"     //For HORSE_SIMD_MATRICES.
 
-//Incase the user wants to set the root later than when initializing the tree.
-Tree::Tree()
+//Columns of the body part matrices are computed on glm's SSE vectors when matrices are composed on them (see
+//SimdMatrix.h) and on plain vectors otherwise.
+#if defined(HORSE_SIMD_MATRICES)
+typedef glm::simdVec4 Column;
+
+static inline Column loadColumn(const glm::vec4 &column)
 {
-	root = NULL;
+	return glm::simdVec4(column);
 }
 
-//Set the root from the get go.
-Tree::Tree(Node* rootParam, GLuint objectColorLocationParam, GLuint transformLocationParam, GLuint VAOparam, int drawTypeParam)
+static inline glm::vec4 storeColumn(const Column &column)
 {
-	root = rootParam;
-	objectColorLocation = objectColorLocationParam;
-	transformLocation = transformLocationParam;
-	VAO = VAOparam;
-	drawType = drawTypeParam;
+	return glm::vec4_cast(column);
 }
+#else
+typedef glm::vec4 Column;
 
-//Draw the horse by doing a pre-order traversal starting from the root.
-void Tree::drawTraversalFromRoot(Stack* scaleMatrixStack, Stack* rotTransMatrixStack)
+static inline Column loadColumn(const glm::vec4 &column)
 {
-	drawTraversal(root, scaleMatrixStack, rotTransMatrixStack);
+	return column;
 }
 
-//Draw the specified body part and it's children by doing a pre-order traversal.
-void Tree::drawTraversal(Node* node, Stack* scaleMatrixStack, Stack* rotTransMatrixStack)
-{
-	//set color
-	//if (!texturesActive)
-	glUniform4f(objectColorLocation, node->getColor().x, node->getColor().y, node->getColor().z, node->getColor().w);
-	scaleMatrixStack->push(node->getScaleMatrix());                                                                         //Keep track of the current matrices being used.
-	rotTransMatrixStack->push(node->getRotTransMatrix());
-	glBindVertexArray(VAO);
-	glUniformMatrix4fv(transformLocation, 1, GL_FALSE, glm::value_ptr(rotTransMatrixStack->top()*scaleMatrixStack->top())); //Utilize scale, then rotate, then translate by getting matrices on top of each stack
-	glDrawArrays(drawType, 0, 36);
-	glBindVertexArray(0);
-	for (int i = 0; i < node->getChildQuantity(); i++)                                                                      //Start drawing the child body parts.
-		drawTraversal(node->getChildAt(i), scaleMatrixStack, rotTransMatrixStack);
-	scaleMatrixStack->pop();                                                                                               //Get rid of current matrices being used so parent can utilize proper matrices.
-	rotTransMatrixStack->pop();
+static inline glm::vec4 storeColumn(const Column &column)
+{
+	return column;
 }
+#endif
 
-//Set where the horse is drawn.
-void Tree::setTransformLocation(int transformLocationParam) {
-	transformLocation = transformLocationParam;
+Tree::Tree()
+{
 }
 
-//Set how the horse is rendered.
-void Tree::setDrawType(int drawTypeParam) {
-	drawType = drawTypeParam;
+//Add a body part hanging off of parent (-1 for the root) and give back its position (-1 if the skeleton is full). Parents
+//have to be added before their children. The body part is moved to offset, rotated around pivot by restAngle plus the
+//joint angle, and drawn scaled by shape (lengths in units of the size given to evaluate()).
+int Tree::addNode(int parent, int joint, float restAngle, glm::vec3 offset, glm::vec3 pivot, glm::vec3 shape)
+{
+	if (nodes.size() == MAX_NODE_QUANTITY)
+		return -1;
+	if (parent >= (int)nodes.size())
+		parent = -1;
+	nodes.push_back(Node(parent, parent == -1 ? -1 : joint, restAngle, offset, pivot, shape));
+	return nodes.size() - 1;
+}
+
+//Compute the world matrix of every body part of one instance of the skeleton in one pass (parents always come first) and
+//write it to worldMatrices, what each body part is drawn with (world matrix, then scale) to modelMatrices and its normal
+//matrix to normalMatrices, in tree order. The root is placed at rootMatrix and every other body part rotates with its
+//joint in jointAngles.
+//Only body parts whose joint angle differs from lastJointAngles, or whose parent was computed, are computed (the root
+//when isRootChanged), so the three buffers have to hold what the last evaluation of this instance wrote. lastJointAngles
+//is NULL the first time, which computes everything. Gives back how many body parts were computed.
+//Every joint translates to its pivot, rotates around z and translates back, which only mixes the first two columns of
+//the parent's matrix and moves it, so that is written out column by column instead of as general matrix products.
+//Local matrices only rotate and translate and scale matrices only scale along the axes, so the inverse transpose of
+//rotation*scale is rotation*(1/scale): each rotation column divided by its scale, with no matrix inverse. This stays
+//right for the non-uniform scales of the body parts.
+int Tree::evaluate(float size, const glm::mat4 &rootMatrix, bool isRootChanged, const float* jointAngles, const float* lastJointAngles,
+	glm::mat4* worldMatrices, glm::mat4* modelMatrices, NormalMatrix* normalMatrices)
+{
+	bool isComputed[MAX_NODE_QUANTITY];   //Children of a computed body part have to be computed too.
+	int computedQuantity = 0;
+	for (int i = 0; i < nodes.size(); i++) {
+		int parent = nodes[i].getParent();
+		int joint = nodes[i].getJoint();
+		if (parent == -1)
+			isComputed[i] = isRootChanged;
+		else
+			isComputed[i] = isComputed[parent] || lastJointAngles == NULL
+				|| memcmp(&jointAngles[joint], &lastJointAngles[joint], sizeof(float)) != 0;
+		if (!isComputed[i])
+			continue;
+		computedQuantity++;
+
+		Column world[4];
+		if (parent == -1)
+			for (int j = 0; j < 4; j++)
+				world[j] = loadColumn(rootMatrix[j]);
+		else {
+			float angle = nodes[i].getRestAngle() + jointAngles[joint];
+			float cosine = cos(angle);
+			float sine = sin(angle);
+			glm::vec3 offset = nodes[i].getOffset()*size;
+			glm::vec3 pivot = nodes[i].getPivot()*size;
+			float translationX = offset.x + pivot.x - (cosine*pivot.x - sine*pivot.y);
+			float translationY = offset.y + pivot.y - (sine*pivot.x + cosine*pivot.y);
+			Column parentX = loadColumn(worldMatrices[parent][0]);
+			Column parentY = loadColumn(worldMatrices[parent][1]);
+			Column parentZ = loadColumn(worldMatrices[parent][2]);
+			Column parentW = loadColumn(worldMatrices[parent][3]);
+			world[0] = parentX * cosine + parentY * sine;
+			world[1] = parentY * cosine - parentX * sine;
+			world[2] = parentZ;
+			world[3] = parentX * translationX + parentY * translationY + parentZ * offset.z + parentW;
+		}
+		glm::vec3 scale = nodes[i].getShape()*size;
+		for (int j = 0; j < 4; j++)
+			worldMatrices[i][j] = storeColumn(world[j]);
+		modelMatrices[i][0] = storeColumn(world[0] * scale.x);
+		modelMatrices[i][1] = storeColumn(world[1] * scale.y);
+		modelMatrices[i][2] = storeColumn(world[2] * scale.z);
+		modelMatrices[i][3] = worldMatrices[i][3];
+		for (int j = 0; j < 3; j++)
+			normalMatrices[i].columns[j] = storeColumn(world[j] * (1.0f / scale[j]));
+	}
+	return computedQuantity;
+}
+
+//GETTERS
+int Tree::getNodeQuantity()
+{
+	return nodes.size();
 }
\ No newline at end of file
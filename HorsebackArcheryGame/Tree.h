@@ -1,21 +1,31 @@
-#include "..\glew\glew.h"	//include GL Extension Wrangler
-#include "..\glfw\glfw3.h"	//include GLFW helper library
+#pragma once
 
-#include "Stack.h"
+#include <vector>
 #include "Node.h"
 
+using namespace std;
+
+//What a body part's normals are transformed with (inverse transpose of the upper 3x3 of its model matrix). Kept as one
+//vec4 per column so it's written with whole SIMD stores and streamed to the GPU as is (the shader only reads xyz).
+struct NormalMatrix {
+	glm::vec4 columns[3];
+};
+
+//A skeleton: body parts stored as one array sorted so that every body part comes after its parent. Every body part's
+//world matrix then only depends on ones already computed, so the whole skeleton is evaluated in a single pass from front
+//to back (no recursion and no matrix stacks). Nothing in the tree changes after it is built, so one skeleton is shared
+//by every horse (and every thread evaluating them), and each horse only brings its size, pose and buffers to write to.
 class Tree {
 	private:
-		Node* root;
-		GLuint objectColorLocation;
-		GLuint transformLocation;
-		GLuint VAO;
-		int drawType;
+		static const int MAX_NODE_QUANTITY = 32;   //Body parts one skeleton can have.
+
+		vector<Node> nodes;
 	public:
 		Tree();
-		Tree(Node* rootParam, GLuint objectColorLocationParam, GLuint transformLocationParam, GLuint VAOParam, int drawTypeParam);
-		void drawTraversalFromRoot(Stack* scaleMatrixStack, Stack* rotTransMatrixStack);
-		void drawTraversal(Node* node, Stack* scaleMatrixStack, Stack* rotTransMatrixStack);
-		void setTransformLocation(int transformLocationParam);
-		void setDrawType(int drawTypeParam);
+		int addNode(int parent, int joint, float restAngle, glm::vec3 offset, glm::vec3 pivot, glm::vec3 shape);
+		int evaluate(float size, const glm::mat4 &rootMatrix, bool isRootChanged, const float* jointAngles, const float* lastJointAngles,
+			glm::mat4* worldMatrices, glm::mat4* modelMatrices, NormalMatrix* normalMatrices);
+
+		//GETTERS
+		int getNodeQuantity();
 };
\ No newline at end of file
@@ -2,16 +2,24 @@
 
 out vec4 color;
 
-uniform vec4 objectColor;
-uniform vec4 lightColor;
-uniform vec3 lightPosition;
-uniform vec3 viewPosition;    //Influences specular lighting.
+//Camera, light and shadow values of the frame, shared by every program (see FrameUniformBuffer).
+layout (std140) uniform FrameConstants {
+	mat4 view_matrix;
+	mat4 projection_matrix;
+	mat4 shadow_view_matrix;
+	mat4 shadow_projection_matrix;
+	vec4 lightColor;
+	vec4 lightPosition;            //Only xyz is used.
+	vec4 viewPosition;             //Only xyz is used, influences specular lighting.
+};
+
 uniform bool shadowsActive;
 
 in vec4 colorPosition;
 in vec2 textureCoordinate;
 in vec3 normalCoordinate;
 in vec4 colorPositionInLight; //For shadow calculations
+in vec4 vertexColor;          //Color of the object (set per instance for horses).
 
 uniform sampler2D textureContent;
 uniform sampler2D shadowMap;
@@ -46,13 +54,13 @@ void main()
 	
 	//Calculates diffuse lighting (i.e. allows color to change when face of object faces towards or away from the light).
 	vec3 normal = normalize(normalCoordinate);
-	vec3 lightDirection = normalize(lightPosition-vec3(colorPosition.x, colorPosition.y, colorPosition.z));
+	vec3 lightDirection = normalize(lightPosition.xyz-vec3(colorPosition.x, colorPosition.y, colorPosition.z));
 	float diffuseCoefficient = max(dot(normal, lightDirection), 0.0); //Don't allow negative values for light related calculations.
 	vec4 diffuse = diffuseCoefficient * lightColor;
 	
 	//Calculates specular lighting (i.e. allows shiny to spot to appear when observing a spot that the light directly shines on)
 	float specularStrength = 0.5;
-	vec3 viewDirection = normalize(viewPosition - vec3(colorPosition.x, colorPosition.y, colorPosition.z)); 
+	vec3 viewDirection = normalize(viewPosition.xyz - vec3(colorPosition.x, colorPosition.y, colorPosition.z)); 
 	vec3 reflectDirection = reflect(-lightDirection, normal);
 	float specularCoefficient = pow(max(dot(viewDirection, reflectDirection), 0.0), 512);  //Don't allow negative values for light related calculations.
 	                                                                                       //The higher the second value, it becomes more shiny but has less area.
@@ -61,8 +69,8 @@ void main()
 	
 	//Final color calculation. Shadow only influences diffuse and specular so shadows aren't complete darkness.
 	float shadow = ShadowCalculation(colorPositionInLight);
-	vec4 finalColor = (ambient + (1.0-shadow) * (diffuse + specular)) * objectColor;
-	//vec4 finalColor = (ambient + diffuse + specular) * objectColor;
+	vec4 finalColor = (ambient + (1.0-shadow) * (diffuse + specular)) * vertexColor;
+	//vec4 finalColor = (ambient + diffuse + specular) * vertexColor;
     color = texture(textureContent, textureCoordinate) * finalColor;
 	
 	//Allows us to debug the shadow map during first pass.
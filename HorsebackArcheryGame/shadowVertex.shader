@@ -2,11 +2,23 @@
 
 //Basic shader solely used to get depth values for shadow map.
 layout (location = 0) in vec3 position;
+layout (location = 3) in mat4 instance_model_matrix; //Per instance model matrix for horse body parts.
+
+//Camera, light and shadow values of the frame, shared by every program (see FrameUniformBuffer).
+layout (std140) uniform FrameConstants {
+	mat4 view_matrix;
+	mat4 projection_matrix;
+	mat4 shadow_view_matrix;
+	mat4 shadow_projection_matrix;
+	vec4 lightColor;
+	vec4 lightPosition;            //Only xyz is used.
+	vec4 viewPosition;             //Only xyz is used, influences specular lighting.
+};
 
 uniform mat4 shadow_model_matrix;
-uniform mat4 shadow_view_matrix;
-uniform mat4 shadow_projection_matrix;
+uniform bool instanced;
 
 void main() {
-	gl_Position = shadow_projection_matrix * shadow_view_matrix * shadow_model_matrix * vec4(position.x, position.y, position.z, 1.0);
+	mat4 model = instanced ? instance_model_matrix : shadow_model_matrix;
+	gl_Position = shadow_projection_matrix * shadow_view_matrix * model * vec4(position.x, position.y, position.z, 1.0);
 }
\ No newline at end of file
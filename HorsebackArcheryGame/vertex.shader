@@ -8,26 +8,48 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texture;
 layout (location = 2) in vec3 normal;
 
-//Matrices used to influence camera.
+//Per instance attributes used when every horse body part is drawn in one call.
+//The model matrix takes up locations 3 to 6 and the normal matrix 8 to 10 (one per column).
+layout (location = 3) in mat4 instance_model_matrix;
+layout (location = 7) in vec4 instance_color;
+layout (location = 8) in mat3 instance_normal_matrix;
+
+//Camera, light and shadow values of the frame, shared by every program (see FrameUniformBuffer).
+layout (std140) uniform FrameConstants {
+	mat4 view_matrix;
+	mat4 projection_matrix;
+	mat4 shadow_view_matrix;
+	mat4 shadow_projection_matrix;
+	vec4 lightColor;
+	vec4 lightPosition;            //Only xyz is used.
+	vec4 viewPosition;             //Only xyz is used, influences specular lighting.
+};
+
+//Matrices used to place an object that isn't instanced. The normal matrix is the inverse transpose of the upper 3x3
+//of the model matrix, computed on the CPU once per object instead of once per vertex.
 uniform mat4 model_matrix;
-uniform mat4 view_matrix;
-uniform mat4 projection_matrix;
+uniform mat3 normal_matrix;
+
+//Color of an object that isn't instanced.
+uniform vec4 objectColor;
 
-//Matrices used to influence shadows.
-uniform mat4 shadow_view_matrix;
-uniform mat4 shadow_projection_matrix;
+//Whether to use the per instance attributes rather than model_matrix, normal_matrix and objectColor.
+uniform bool instanced;
 
 //Sent to fragment shader.
 out vec4 colorPosition;
 out vec2 textureCoordinate;
 out vec3 normalCoordinate;
 out vec4 colorPositionInLight;
+out vec4 vertexColor;
 
 void main()
 {
-	colorPosition = model_matrix * vec4(position.x, position.y, position.z, 1.0); //Basis for when the color of an object is changed (solely used for calculation of normals).
+	mat4 model = instanced ? instance_model_matrix : model_matrix;
+	vertexColor = instanced ? instance_color : objectColor;
+	colorPosition = model * vec4(position.x, position.y, position.z, 1.0); //Basis for when the color of an object is changed (solely used for calculation of normals).
     textureCoordinate = texture;
-	normalCoordinate = mat3(transpose(inverse(model_matrix))) * normal; //Allows lighting to be changed when objects change position.
+	normalCoordinate = (instanced ? instance_normal_matrix : normal_matrix) * normal; //Allows lighting to be changed when objects change position.
 	colorPositionInLight = shadow_projection_matrix * shadow_view_matrix * colorPosition;
-	gl_Position = projection_matrix * view_matrix * model_matrix * vec4(position.x, position.y, position.z, 1.0); //Camera position.
+	gl_Position = projection_matrix * view_matrix * model * vec4(position.x, position.y, position.z, 1.0); //Camera position.
 }
\ No newline at end of file